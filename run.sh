@@ -10,5 +10,6 @@ cp -r src/ ${NS3_DIR}/scratch
 # 2. Entering the NS3 directory
 cd ${NS3_DIR}
 
-# 3. Running NS3
-./ns3 run scratch/src/main.cc
\ No newline at end of file
+# 3. Running NS3. Extra arguments are passed to the simulation, e.g.
+# ./run.sh --instance=scratch/src/data/data.txt --sensors=4 --pollPeriod=0.5 --stopTime=20
+./ns3 run "scratch/src/main.cc $*"
\ No newline at end of file
@@ -0,0 +1,132 @@
+#include "ns3/log.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-static-routing-helper.h"
+#include "include/address-planner.h"
+
+namespace ns3
+{
+    NS_LOG_COMPONENT_DEFINE("AddressPlanner");
+
+    static const uint32_t SITE_PREFIX = 8;
+    static const uint32_t BLOCK_PREFIX = 16;
+    static const uint32_t SUBNET_PREFIX = 20;
+
+    static uint32_t PrefixMask(uint32_t prefix)
+    {
+        return ~((1u << (32 - prefix)) - 1);
+    }
+
+    AddressPlanner::AddressPlanner()
+    {
+        m_site = Ipv4Address("10.0.0.0").Get();
+    }
+
+    AddressPlanner::AddressPlanner(Ipv4Address site)
+    {
+        m_site = site.Get() & PrefixMask(SITE_PREFIX);
+    }
+
+    Ipv4Address AddressPlanner::GetSiteNetwork() const
+    {
+        return Ipv4Address(m_site);
+    }
+
+    Ipv4Mask AddressPlanner::GetSiteMask() const
+    {
+        return Ipv4Mask(PrefixMask(SITE_PREFIX));
+    }
+
+    Ipv4Address AddressPlanner::GetAisleNetwork(uint32_t aisle) const
+    {
+        return Ipv4Address(m_site | ((aisle + 1) << (32 - BLOCK_PREFIX)));
+    }
+
+    Ipv4Mask AddressPlanner::GetAisleMask() const
+    {
+        return Ipv4Mask(PrefixMask(BLOCK_PREFIX));
+    }
+
+    Ipv4Address AddressPlanner::GetBlockSubnet(uint32_t block, uint32_t role) const
+    {
+        return Ipv4Address(m_site | (block << (32 - BLOCK_PREFIX)) | (role << (32 - SUBNET_PREFIX)));
+    }
+
+    Ipv4Address AddressPlanner::GetSubnet(uint32_t aisle, uint32_t role) const
+    {
+        return GetBlockSubnet(aisle + 1, role);
+    }
+
+    Ipv4Address AddressPlanner::GetSubnetBroadcast(uint32_t aisle, uint32_t role) const
+    {
+        return Ipv4Address(GetSubnet(aisle, role).Get() | ~PrefixMask(SUBNET_PREFIX));
+    }
+
+    uint32_t AddressPlanner::GetSubnetCount() const
+    {
+        uint32_t count = 0;
+        for (uint32_t used : m_assigned)
+        {
+            count += used > 0;
+        }
+        return count;
+    }
+
+    Ipv4InterfaceContainer AddressPlanner::AssignAisle(const NetDeviceContainer &devices, uint32_t aisle, uint32_t role)
+    {
+        if (aisle >= MAX_AISLES)
+        {
+            NS_FATAL_ERROR("Aisle " << aisle << " exceeds the " << MAX_AISLES << " aisles of the address plan");
+        }
+        return Assign(devices, aisle + 1, role);
+    }
+
+    Ipv4InterfaceContainer AddressPlanner::AssignInfrastructure(const NetDeviceContainer &devices, uint32_t role)
+    {
+        return Assign(devices, 0, role);
+    }
+
+    Ipv4InterfaceContainer AddressPlanner::Assign(const NetDeviceContainer &devices, uint32_t block, uint32_t role)
+    {
+        uint32_t index = block * NODE_ROLES + role;
+        if (index >= m_assigned.size())
+        {
+            m_assigned.resize(index + 1, 0);
+        }
+        if (m_assigned[index] + devices.GetN() > MAX_SUBNET_HOSTS)
+        {
+            NS_FATAL_ERROR("Subnet " << GetBlockSubnet(block, role) << "/" << SUBNET_PREFIX << " cannot hold "
+                                     << m_assigned[index] + devices.GetN() << " addresses");
+        }
+        // o helper começa do primeiro endereço livre da sub-rede, e o gerador global do ns-3 acusa repetições
+        Ipv4AddressHelper helper(GetBlockSubnet(block, role), Ipv4Mask(PrefixMask(SUBNET_PREFIX)),
+                                 Ipv4Address(m_assigned[index] + 1));
+        m_assigned[index] += devices.GetN();
+        NS_LOG_INFO("Sub-rede " << GetBlockSubnet(block, role) << "/" << SUBNET_PREFIX << ": " << m_assigned[index] << " endereços");
+        return helper.Assign(devices);
+    }
+
+    void AddressPlanner::AddSiteRoutes(const Ipv4InterfaceContainer &interfaces) const
+    {
+        Ipv4StaticRoutingHelper routing;
+        for (Ipv4InterfaceContainer::Iterator it = interfaces.Begin(); it != interfaces.End(); it++)
+        {
+            routing.GetStaticRouting(it->first)->AddNetworkRouteTo(GetSiteNetwork(), GetSiteMask(), it->second);
+        }
+    }
+
+    void AddressPlanner::AddSiteRoutes(const Ipv4InterfaceContainer &interfaces, Ipv4Address nextHop) const
+    {
+        Ipv4StaticRoutingHelper routing;
+        for (Ipv4InterfaceContainer::Iterator it = interfaces.Begin(); it != interfaces.End(); it++)
+        {
+            routing.GetStaticRouting(it->first)->AddNetworkRouteTo(GetSiteNetwork(), GetSiteMask(), nextHop, it->second);
+        }
+    }
+
+    void AddressPlanner::AddAisleRoute(Ptr<Node> node, uint32_t aisle, Ipv4Address nextHop, uint32_t interface) const
+    {
+        Ipv4StaticRoutingHelper routing;
+        routing.GetStaticRouting(node->GetObject<Ipv4>())->AddNetworkRouteTo(GetAisleNetwork(aisle), GetAisleMask(), nextHop, interface);
+    }
+}
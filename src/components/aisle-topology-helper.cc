@@ -0,0 +1,392 @@
+#include "ns3/log.h"
+#include "ns3/string.h"
+#include "ns3/boolean.h"
+#include "ns3/ssid.h"
+#include "ns3/ipv4.h"
+#include "ns3/csma-helper.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/yans-wifi-channel.h"
+#include "include/aisle-topology-helper.h"
+#include <algorithm>
+#include <limits>
+#include <map>
+
+namespace ns3
+{
+    NS_LOG_COMPONENT_DEFINE("AisleTopologyHelper");
+
+    /** Altura do ponto de acesso na entrada do corredor, em metros */
+    static const double ACCESS_POINT_HEIGHT = 3.0;
+
+    /** Canais sem sobreposição de 20 MHz (ou 22 MHz, no 802.11b) em 2,4 GHz e de 20 a 160 MHz em 5 GHz */
+    static const uint8_t CHANNELS_2_4GHZ_20[] = {1, 6, 11};
+    static const uint8_t CHANNELS_2_4GHZ_40[] = {3};
+    static const uint8_t CHANNELS_5GHZ_20[] = {36, 40, 44, 48, 52, 56, 60, 64, 100, 104, 108, 112, 116, 120, 124, 128, 132, 136, 140, 144, 149, 153, 157, 161, 165};
+    static const uint8_t CHANNELS_5GHZ_40[] = {38, 46, 54, 62, 102, 110, 118, 126, 134, 142, 151, 159};
+    static const uint8_t CHANNELS_5GHZ_80[] = {42, 58, 106, 122, 138, 155};
+    static const uint8_t CHANNELS_5GHZ_160[] = {50, 114};
+
+    static NetDeviceContainer Slice(const NetDeviceContainer &devices, uint32_t first, uint32_t count)
+    {
+        NetDeviceContainer slice;
+        for (uint32_t i = first; i < first + count; i++)
+        {
+            slice.Add(devices.Get(i));
+        }
+        return slice;
+    }
+
+    static void SetPosition(Ptr<Node> node, Vector position)
+    {
+        Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel>();
+        mobility->SetPosition(position);
+        node->AggregateObject(mobility);
+    }
+
+    AisleTopologyHelper::AisleTopologyHelper(uint32_t shelves, uint32_t shelvesPerAisle)
+    {
+        NS_ASSERT(shelvesPerAisle > 0);
+        m_shelves = shelves;
+        m_shelvesPerAisle = shelvesPerAisle;
+        m_aisles = (shelves + shelvesPerAisle - 1) / shelvesPerAisle;
+        m_serverCount = 1;
+        m_backhaul = BACKHAUL_CSMA;
+        m_dataRate = "100Mbps";
+        m_delay = MicroSeconds(50);
+        m_aisleSpacing = 10.0;
+        m_shelfSpacing = 2.0;
+        m_shelfHeight = 2.0;
+        m_band = WIFI_PHY_BAND_5GHZ;
+        m_channelWidth = 20;
+        m_channels = GetNonOverlappingChannels(m_band, m_channelWidth);
+        m_interferenceRange = 30.0;
+    }
+
+    void AisleTopologyHelper::SetServers(uint32_t servers)
+    {
+        m_serverCount = servers;
+    }
+
+    void AisleTopologyHelper::SetBackhaul(Backhaul backhaul, std::string dataRate, Time delay)
+    {
+        m_backhaul = backhaul;
+        m_dataRate = dataRate;
+        m_delay = delay;
+    }
+
+    void AisleTopologyHelper::SetLayout(double aisleSpacing, double shelfSpacing, double shelfHeight)
+    {
+        m_aisleSpacing = aisleSpacing;
+        m_shelfSpacing = shelfSpacing;
+        m_shelfHeight = shelfHeight;
+    }
+
+    void AisleTopologyHelper::SetChannels(WifiPhyBand band, uint16_t width, const std::vector<uint8_t> &channels)
+    {
+        NS_ASSERT(!channels.empty());
+        m_band = band;
+        m_channelWidth = width;
+        m_channels = channels;
+    }
+
+    void AisleTopologyHelper::SetInterferenceRange(double range)
+    {
+        m_interferenceRange = range;
+    }
+
+    std::vector<uint8_t> AisleTopologyHelper::GetNonOverlappingChannels(WifiPhyBand band, uint16_t width)
+    {
+        if (band == WIFI_PHY_BAND_2_4GHZ)
+        {
+            if (width <= 22)
+            {
+                return std::vector<uint8_t>(std::begin(CHANNELS_2_4GHZ_20), std::end(CHANNELS_2_4GHZ_20));
+            }
+            if (width == 40)
+            {
+                return std::vector<uint8_t>(std::begin(CHANNELS_2_4GHZ_40), std::end(CHANNELS_2_4GHZ_40));
+            }
+        }
+        else if (band == WIFI_PHY_BAND_5GHZ)
+        {
+            switch (width)
+            {
+                case 20:
+                    return std::vector<uint8_t>(std::begin(CHANNELS_5GHZ_20), std::end(CHANNELS_5GHZ_20));
+                case 40:
+                    return std::vector<uint8_t>(std::begin(CHANNELS_5GHZ_40), std::end(CHANNELS_5GHZ_40));
+                case 80:
+                    return std::vector<uint8_t>(std::begin(CHANNELS_5GHZ_80), std::end(CHANNELS_5GHZ_80));
+                case 160:
+                    return std::vector<uint8_t>(std::begin(CHANNELS_5GHZ_160), std::end(CHANNELS_5GHZ_160));
+            }
+        }
+        return std::vector<uint8_t>();
+    }
+
+    uint32_t AisleTopologyHelper::GetAisleCount() const
+    {
+        return m_aisles;
+    }
+
+    uint32_t AisleTopologyHelper::GetAisle(uint32_t shelf) const
+    {
+        return shelf / m_shelvesPerAisle;
+    }
+
+    void AisleTopologyHelper::Build(const WifiHelper &wifi, YansWifiPhyHelper phy, const YansWifiChannelHelper &channel, AddressPlanner &planner)
+    {
+        m_sensors.Create(m_shelves);
+        m_accessPoints.Create(m_aisles);
+        m_servers.Create(m_serverCount);
+        m_relays.Create(2);
+        m_gateway.Create(1);
+        NodeContainer infrastructure(NodeContainer(m_servers, m_relays), m_gateway);
+
+        InternetStackHelper stack;
+        stack.Install(infrastructure);
+        stack.Install(m_accessPoints);
+        stack.Install(m_sensors);
+        Place();
+
+        // Rede local da infraestrutura, da qual os pontos de acesso também fazem parte com BACKHAUL_CSMA
+        CsmaHelper csma;
+        csma.SetChannelAttribute("DataRate", StringValue(m_dataRate));
+        csma.SetChannelAttribute("Delay", TimeValue(m_delay));
+        NodeContainer lan = infrastructure;
+        if (m_backhaul == BACKHAUL_CSMA)
+        {
+            lan.Add(m_accessPoints);
+        }
+        NetDeviceContainer lanDevices = csma.Install(lan);
+        m_serverInterfaces = planner.AssignInfrastructure(Slice(lanDevices, 0, m_serverCount), ROLE_SERVER);
+        m_relayInterfaces = planner.AssignInfrastructure(Slice(lanDevices, m_serverCount, 2), ROLE_RELAY);
+        m_gatewayInterfaces = planner.AssignInfrastructure(Slice(lanDevices, m_serverCount + 2, 1), ROLE_GATEWAY);
+        BuildBackhaul(lanDevices, planner);
+
+        // Uma célula por corredor: o ponto de acesso e os sensores das suas prateleiras, com SSID e canal próprios
+        AssignChannels();
+        std::map<uint8_t, Ptr<YansWifiChannel>> channels; // as células de um mesmo canal disputam o mesmo meio
+        WifiMacHelper mac;
+        for (uint32_t aisle = 0; aisle < m_aisles; aisle++)
+        {
+            uint8_t number = m_cellChannels[aisle];
+            if (channels.find(number) == channels.end())
+            {
+                channels[number] = channel.Create();
+            }
+            phy.SetChannel(channels[number]);
+            phy.Set("ChannelSettings", StringValue("{" + std::to_string(number) + ", " + std::to_string(m_channelWidth) + ", "
+                                                   + (m_band == WIFI_PHY_BAND_2_4GHZ ? "BAND_2_4GHZ" : "BAND_5GHZ") + ", 0}"));
+
+            Ssid ssid = Ssid("aisle-" + std::to_string(aisle));
+            NodeContainer sensors;
+            for (uint32_t i = aisle * m_shelvesPerAisle; i < std::min((aisle + 1) * m_shelvesPerAisle, m_shelves); i++)
+            {
+                sensors.Add(m_sensors.Get(i));
+            }
+            mac.SetType("ns3::ApWifiMac", "Ssid", SsidValue(ssid));
+            NetDeviceContainer apDevice = wifi.Install(phy, mac, m_accessPoints.Get(aisle));
+            mac.SetType("ns3::StaWifiMac", "Ssid", SsidValue(ssid), "ActiveProbing", BooleanValue(false));
+            NetDeviceContainer sensorDevices = wifi.Install(phy, mac, sensors);
+            m_cellDevices.push_back(NetDeviceContainer(apDevice, sensorDevices));
+
+            // o ponto de acesso fica com o primeiro endereço da sub-rede das prateleiras e é a rota dos sensores para o armazém
+            Ipv4InterfaceContainer cell = planner.AssignAisle(apDevice, aisle);
+            Ipv4InterfaceContainer sensorInterfaces = planner.AssignAisle(sensorDevices, aisle);
+            planner.AddSiteRoutes(sensorInterfaces, cell.GetAddress(0));
+            m_cellInterfaces.Add(cell);
+            m_sensorInterfaces.Add(sensorInterfaces);
+        }
+        NS_LOG_INFO(m_aisles << " corredores, " << m_shelves << " sensores, " << planner.GetSubnetCount() << " sub-redes, "
+                             << channels.size() << " canais");
+    }
+
+    void AisleTopologyHelper::AssignChannels()
+    {
+        std::vector<Vector> positions;
+        for (uint32_t aisle = 0; aisle < m_aisles; aisle++)
+        {
+            positions.push_back(m_accessPoints.Get(aisle)->GetObject<MobilityModel>()->GetPosition());
+        }
+        // Coloração gulosa na ordem dos corredores: com os pontos de acesso em linha, ela já alterna os canais
+        // entre corredores vizinhos sempre que há canais suficientes para o alcance de interferência
+        m_cellChannels.assign(m_aisles, 0);
+        for (uint32_t aisle = 0; aisle < m_aisles; aisle++)
+        {
+            std::vector<double> nearest(m_channels.size(), std::numeric_limits<double>::infinity());
+            for (uint32_t other = 0; other < aisle; other++)
+            {
+                uint32_t color = std::find(m_channels.begin(), m_channels.end(), m_cellChannels[other]) - m_channels.begin();
+                nearest[color] = std::min(nearest[color], CalculateDistance(positions[aisle], positions[other]));
+            }
+            uint32_t best = 0;
+            for (uint32_t color = 0; color < m_channels.size(); color++)
+            {
+                if (nearest[color] > m_interferenceRange)
+                {
+                    best = color; // primeiro canal livre na vizinhança
+                    break;
+                }
+                if (nearest[color] > nearest[best])
+                {
+                    best = color;
+                }
+            }
+            m_cellChannels[aisle] = m_channels[best];
+            NS_LOG_INFO("Corredor " << aisle << ": canal " << (uint32_t)m_channels[best]);
+        }
+    }
+
+    void AisleTopologyHelper::BuildBackhaul(const NetDeviceContainer &lanDevices, AddressPlanner &planner)
+    {
+        Ipv4InterfaceContainer lanInterfaces;
+        lanInterfaces.Add(m_serverInterfaces);
+        lanInterfaces.Add(m_relayInterfaces);
+        lanInterfaces.Add(m_gatewayInterfaces);
+        planner.AddSiteRoutes(lanInterfaces); // as sub-redes de cada papel da infraestrutura estão todas na rede local
+        Ipv4Address core = m_relayInterfaces.GetAddress(1);
+
+        if (m_backhaul == BACKHAUL_CSMA)
+        {
+            m_uplinkInterfaces = planner.AssignInfrastructure(Slice(lanDevices, m_serverCount + 3, m_aisles), ROLE_RELAY);
+            planner.AddSiteRoutes(m_uplinkInterfaces);
+            for (uint32_t aisle = 0; aisle < m_aisles; aisle++)
+            {
+                m_coreInterfaces.Add(m_relayInterfaces.Get(1));
+                for (uint32_t i = 0; i < lanInterfaces.GetN(); i++)
+                {
+                    std::pair<Ptr<Ipv4>, uint32_t> lanInterface = lanInterfaces.Get(i);
+                    planner.AddAisleRoute(lanInterface.first->GetObject<Node>(), aisle, m_uplinkInterfaces.GetAddress(aisle), lanInterface.second);
+                }
+            }
+            return;
+        }
+
+        // BACKHAUL_P2P: um enlace entre o intermediário dos sensores e cada ponto de acesso, na sub-rede de intermediários do corredor
+        PointToPointHelper p2p;
+        p2p.SetDeviceAttribute("DataRate", StringValue(m_dataRate));
+        p2p.SetChannelAttribute("Delay", TimeValue(m_delay));
+        Ptr<Node> coreNode = m_relays.Get(1);
+        for (uint32_t aisle = 0; aisle < m_aisles; aisle++)
+        {
+            Ipv4InterfaceContainer link = planner.AssignAisle(p2p.Install(coreNode, m_accessPoints.Get(aisle)), aisle, ROLE_RELAY);
+            m_coreInterfaces.Add(link.Get(0));
+            m_uplinkInterfaces.Add(link.Get(1));
+            Ipv4InterfaceContainer uplink;
+            uplink.Add(link.Get(1));
+            planner.AddSiteRoutes(uplink, link.GetAddress(0));
+            planner.AddAisleRoute(coreNode, aisle, link.GetAddress(1), link.Get(0).second);
+            for (uint32_t i = 0; i < lanInterfaces.GetN(); i++) // os demais nós da infraestrutura chegam aos corredores pelo núcleo
+            {
+                std::pair<Ptr<Ipv4>, uint32_t> lanInterface = lanInterfaces.Get(i);
+                Ptr<Node> node = lanInterface.first->GetObject<Node>();
+                if (node != coreNode)
+                {
+                    planner.AddAisleRoute(node, aisle, core, lanInterface.second);
+                }
+            }
+        }
+    }
+
+    void AisleTopologyHelper::Place()
+    {
+        double x = -m_aisleSpacing;
+        for (uint32_t i = 0; i < m_servers.GetN(); i++)
+        {
+            SetPosition(m_servers.Get(i), Vector(x, 5.0 * i, 0.0));
+        }
+        SetPosition(m_relays.Get(0), Vector(x, -5.0, 0.0));
+        SetPosition(m_relays.Get(1), Vector(x, -10.0, 0.0));
+        SetPosition(m_gateway.Get(0), Vector(x, -15.0, 0.0));
+
+        for (uint32_t aisle = 0; aisle < m_aisles; aisle++)
+        {
+            SetPosition(m_accessPoints.Get(aisle), Vector(aisle * m_aisleSpacing, 0.0, ACCESS_POINT_HEIGHT));
+        }
+        for (uint32_t i = 0; i < m_shelves; i++) // pares de prateleiras empilhadas ao longo do corredor
+        {
+            uint32_t position = i % m_shelvesPerAisle;
+            SetPosition(m_sensors.Get(i), Vector(GetAisle(i) * m_aisleSpacing, m_shelfSpacing * (position / 2 + 1), (position % 2) * m_shelfHeight));
+        }
+    }
+
+    const NodeContainer &AisleTopologyHelper::GetSensors() const
+    {
+        return m_sensors;
+    }
+
+    const NodeContainer &AisleTopologyHelper::GetAccessPoints() const
+    {
+        return m_accessPoints;
+    }
+
+    const NodeContainer &AisleTopologyHelper::GetServers() const
+    {
+        return m_servers;
+    }
+
+    const NodeContainer &AisleTopologyHelper::GetRelays() const
+    {
+        return m_relays;
+    }
+
+    const NodeContainer &AisleTopologyHelper::GetGateway() const
+    {
+        return m_gateway;
+    }
+
+    const Ipv4InterfaceContainer &AisleTopologyHelper::GetSensorInterfaces() const
+    {
+        return m_sensorInterfaces;
+    }
+
+    const Ipv4InterfaceContainer &AisleTopologyHelper::GetServerInterfaces() const
+    {
+        return m_serverInterfaces;
+    }
+
+    const Ipv4InterfaceContainer &AisleTopologyHelper::GetRelayInterfaces() const
+    {
+        return m_relayInterfaces;
+    }
+
+    const Ipv4InterfaceContainer &AisleTopologyHelper::GetGatewayInterfaces() const
+    {
+        return m_gatewayInterfaces;
+    }
+
+    uint8_t AisleTopologyHelper::GetChannelNumber(uint32_t aisle) const
+    {
+        return m_cellChannels[aisle];
+    }
+
+    uint32_t AisleTopologyHelper::GetChannelCount() const
+    {
+        std::vector<uint8_t> used(m_cellChannels);
+        std::sort(used.begin(), used.end());
+        return std::unique(used.begin(), used.end()) - used.begin();
+    }
+
+    const NetDeviceContainer &AisleTopologyHelper::GetCellDevices(uint32_t aisle) const
+    {
+        return m_cellDevices[aisle];
+    }
+
+    Ipv4Address AisleTopologyHelper::GetAccessPointAddress(uint32_t aisle) const
+    {
+        return m_cellInterfaces.GetAddress(aisle);
+    }
+
+    Ipv4Address AisleTopologyHelper::GetAccessPointUplinkAddress(uint32_t aisle) const
+    {
+        return m_uplinkInterfaces.GetAddress(aisle);
+    }
+
+    Ipv4Address AisleTopologyHelper::GetCoreAddress(uint32_t aisle) const
+    {
+        return m_coreInterfaces.GetAddress(aisle);
+    }
+}
@@ -0,0 +1,301 @@
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/inet-socket-address.h"
+#include "include/arq-endpoint.h"
+#include <cmath>
+
+namespace ns3
+{
+    NS_LOG_COMPONENT_DEFINE("ArqEndpoint");
+
+    ArqStats ArqEndpoint::s_stats = {0, 0, 0, 0, 0, 0, 0, 0};
+
+    /** Limites do RTO, em segundos (RFC 6298, reduzidos para a escala de uma rede local) */
+    static const double INITIAL_RTO = 0.2;
+    static const double MIN_RTO = 0.01;
+    static const double MAX_RTO = 2.0;
+
+    ArqEndpoint::ArqEndpoint(Ptr<Socket> socket, uint16_t port, bool enabled)
+    {
+        m_socket = socket;
+        m_port = port;
+        m_enabled = enabled;
+    }
+
+    ArqEndpoint::~ArqEndpoint()
+    {
+        Close();
+    }
+
+    bool ArqEndpoint::IsEnabled() const
+    {
+        return m_enabled;
+    }
+
+    ArqEndpoint::Peer &ArqEndpoint::GetPeer(Ipv4Address address)
+    {
+        std::map<Ipv4Address, Peer>::iterator it = m_peers.find(address);
+        if (it != m_peers.end())
+        {
+            return it->second;
+        }
+        Peer &peer = m_peers[address];
+        peer.nextSequence = 0;
+        peer.srtt = -1;
+        peer.rttvar = 0;
+        peer.rto = Seconds(INITIAL_RTO);
+        peer.forwardPending = false;
+        peer.forward = 0;
+        peer.expected = 0;
+        peer.received = 0;
+        return peer;
+    }
+
+    uint16_t ArqEndpoint::NextSequence(Ipv4Address peer)
+    {
+        return GetPeer(peer).nextSequence++;
+    }
+
+    void ArqEndpoint::OnSent(Ipv4Address peer, uint16_t sequence, const uint8_t *bytes, uint32_t size, const LatencyTag &tag)
+    {
+        Peer &p = GetPeer(peer);
+        if (p.unacked.size() == MAX_UNACKED)
+        {
+            // o receptor não aceitaria um número além da sua janela; o quadro mais antigo é abandonado
+            NS_LOG_INFO("Janela cheia para " << peer << ", quadro " << p.unacked.front().sequence << " abandonado.");
+            Abandon(peer, p);
+        }
+        p.unacked.push_back(Unacked());
+        Unacked &frame = p.unacked.back();
+        frame.sequence = sequence;
+        frame.retries = 0;
+        frame.sentAt = Simulator::Now();
+        frame.tag = tag;
+        frame.bytes.assign(bytes, bytes + size);
+        s_stats.reliableFrames++;
+
+        if (!p.timer.IsRunning())
+        {
+            p.timer = Simulator::Schedule(p.rto, &ArqEndpoint::Timeout, this, peer);
+        }
+    }
+
+    bool ArqEndpoint::Receive(Ipv4Address from, const FrameHeader &header, uint32_t size)
+    {
+        if (header.flags & FRAME_FLAG_ACK)
+        {
+            HandleAck(from, header.sequence);
+            return false;
+        }
+        if (header.flags & FRAME_FLAG_FORWARD)
+        {
+            HandleForward(from, header.sequence);
+            return false;
+        }
+        if (!(header.flags & FRAME_FLAG_RELIABLE)) // difusão, ou remetente sem ARQ
+        {
+            s_stats.deliveredFrames++;
+            s_stats.deliveredBytes += size;
+            return true;
+        }
+
+        Peer &p = GetPeer(from);
+        int16_t offset = (int16_t)(header.sequence - p.expected);
+        bool fresh = false;
+        if (offset < 0 || (offset < (int16_t)MAX_UNACKED && (p.received >> offset) & 1))
+        {
+            s_stats.duplicates++; // a confirmação anterior se perdeu; confirma de novo abaixo
+        }
+        else if (offset >= (int16_t)MAX_UNACKED)
+        {
+            s_stats.outOfWindow++;
+        }
+        else
+        {
+            fresh = true;
+            p.received |= uint64_t(1) << offset;
+            while (p.received & 1) // avança sobre os quadros já recebidos em sequência
+            {
+                p.received >>= 1;
+                p.expected++;
+            }
+        }
+        SendControl(from, FRAME_FLAG_ACK, p.expected);
+
+        if (fresh)
+        {
+            s_stats.deliveredFrames++;
+            s_stats.deliveredBytes += size;
+        }
+        return fresh;
+    }
+
+    void ArqEndpoint::HandleAck(Ipv4Address from, uint16_t ack)
+    {
+        std::map<Ipv4Address, Peer>::iterator it = m_peers.find(from);
+        if (it == m_peers.end())
+        {
+            return;
+        }
+        Peer &p = it->second;
+        if (p.forwardPending && (int16_t)(ack - p.forward) >= 0) // o receptor já pulou os quadros abandonados
+        {
+            p.forwardPending = false;
+        }
+        double sample = -1;
+        bool progress = false;
+        while (!p.unacked.empty() && (int16_t)(p.unacked.front().sequence - ack) < 0)
+        {
+            const Unacked &frame = p.unacked.front();
+            if (frame.retries == 0) // Karn: quadros reenviados não medem o RTT
+            {
+                sample = (Simulator::Now() - frame.sentAt).GetSeconds();
+            }
+            p.unacked.pop_front();
+            progress = true;
+        }
+        if (!progress) // confirmação repetida
+        {
+            return;
+        }
+
+        if (sample >= 0)
+        {
+            if (p.srtt < 0)
+            {
+                p.srtt = sample;
+                p.rttvar = sample / 2;
+            }
+            else
+            {
+                p.rttvar = 0.75 * p.rttvar + 0.25 * std::fabs(p.srtt - sample);
+                p.srtt = 0.875 * p.srtt + 0.125 * sample;
+            }
+        }
+        if (p.srtt >= 0) // a confirmação desfaz o recuo exponencial
+        {
+            double rto = p.srtt + 4 * p.rttvar;
+            p.rto = Seconds(rto < MIN_RTO ? MIN_RTO : (rto > MAX_RTO ? MAX_RTO : rto));
+        }
+
+        Simulator::Cancel(p.timer);
+        if (!p.unacked.empty() || p.forwardPending)
+        {
+            p.timer = Simulator::Schedule(p.rto, &ArqEndpoint::Timeout, this, from);
+        }
+    }
+
+    void ArqEndpoint::HandleForward(Ipv4Address from, uint16_t forward)
+    {
+        Peer &p = GetPeer(from);
+        while ((int16_t)(forward - p.expected) > 0) // os quadros que faltam até forward não virão mais
+        {
+            p.received >>= 1;
+            p.expected++;
+        }
+        while (p.received & 1)
+        {
+            p.received >>= 1;
+            p.expected++;
+        }
+        SendControl(from, FRAME_FLAG_ACK, p.expected);
+    }
+
+    void ArqEndpoint::Abandon(Ipv4Address peer, Peer &p)
+    {
+        p.unacked.pop_front();
+        s_stats.failed++;
+        p.forward = p.unacked.empty() ? p.nextSequence : p.unacked.front().sequence;
+        p.forwardPending = true;
+        SendControl(peer, FRAME_FLAG_FORWARD, p.forward);
+    }
+
+    void ArqEndpoint::Timeout(Ipv4Address peer)
+    {
+        Peer &p = m_peers[peer];
+        bool forwarded = false;
+        if (!p.unacked.empty())
+        {
+            Unacked &frame = p.unacked.front();
+            if (frame.retries == MAX_RETRIES)
+            {
+                NS_LOG_INFO("Quadro " << frame.sequence << " para " << peer << " abandonado após " << MAX_RETRIES << " reenvios.");
+                Abandon(peer, p);
+                forwarded = true;
+            }
+            else
+            {
+                frame.retries++;
+                Transmit(peer, frame);
+                s_stats.retransmissions++;
+            }
+        }
+        if (p.forwardPending && !forwarded) // o aviso anterior ou sua confirmação se perdeu
+        {
+            SendControl(peer, FRAME_FLAG_FORWARD, p.forward);
+        }
+
+        Time doubled = p.rto + p.rto;
+        p.rto = doubled > Seconds(MAX_RTO) ? Seconds(MAX_RTO) : doubled;
+        if (!p.unacked.empty() || p.forwardPending)
+        {
+            p.timer = Simulator::Schedule(p.rto, &ArqEndpoint::Timeout, this, peer);
+        }
+    }
+
+    void ArqEndpoint::Transmit(Ipv4Address to, const Unacked &frame)
+    {
+        NS_LOG_FUNCTION(this << to << frame.sequence);
+        Ptr<Packet> packet = Create<Packet>(frame.bytes.data(), frame.bytes.size());
+        packet->AddPacketTag(frame.tag); // o reenvio conta como o mesmo salto, a latência inclui a espera
+        m_socket->SendTo(packet, 0, InetSocketAddress(to, m_port));
+    }
+
+    void ArqEndpoint::SendControl(Ipv4Address to, uint8_t flags, uint16_t sequence)
+    {
+        FrameHeader header;
+        header.version = WAREHOUSE_PROTOCOL_VERSION;
+        header.flags = flags;
+        header.sequence = sequence;
+        header.recordCount = 0;
+        uint8_t bytes[FRAME_HEADER_SIZE];
+        EncodeFrameHeader(header, bytes);
+        m_socket->SendTo(Create<Packet>(bytes, FRAME_HEADER_SIZE), 0, InetSocketAddress(to, m_port));
+        if (flags & FRAME_FLAG_ACK)
+        {
+            s_stats.acksSent++;
+        }
+    }
+
+    void ArqEndpoint::Close()
+    {
+        for (std::map<Ipv4Address, Peer>::iterator it = m_peers.begin(); it != m_peers.end(); it++)
+        {
+            Simulator::Cancel(it->second.timer);
+        }
+    }
+
+    Time ArqEndpoint::GetRto(Ipv4Address peer) const
+    {
+        std::map<Ipv4Address, Peer>::const_iterator it = m_peers.find(peer);
+        return it == m_peers.end() ? Seconds(INITIAL_RTO) : it->second.rto;
+    }
+
+    uint32_t ArqEndpoint::GetMemoryUsage() const
+    {
+        uint32_t bytes = sizeof(*this) + m_peers.size() * (sizeof(Peer) + 4 * sizeof(void *));
+        for (std::map<Ipv4Address, Peer>::const_iterator it = m_peers.begin(); it != m_peers.end(); it++)
+        {
+            for (uint32_t i = 0; i < it->second.unacked.size(); i++)
+            {
+                bytes += sizeof(Unacked) + it->second.unacked[i].bytes.capacity();
+            }
+        }
+        return bytes;
+    }
+
+    const ArqStats &ArqEndpoint::GetStats()
+    {
+        return s_stats;
+    }
+}
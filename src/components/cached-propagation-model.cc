@@ -0,0 +1,139 @@
+#include "ns3/log.h"
+#include "ns3/pointer.h"
+#include "include/cached-propagation-model.h"
+
+namespace ns3
+{
+    NS_LOG_COMPONENT_DEFINE("CachedPropagationModel");
+    NS_OBJECT_ENSURE_REGISTERED(CachedPropagationLossModel);
+    NS_OBJECT_ENSURE_REGISTERED(CachedPropagationDelayModel);
+
+    PropagationCacheStats MobilityPairCache::s_stats = {0, 0, 0};
+
+    MobilityPairCache::MobilityPairCache()
+    {
+    }
+
+    const PropagationCacheStats &MobilityPairCache::GetStats()
+    {
+        return s_stats;
+    }
+
+    uint32_t MobilityPairCache::GetIndex(Ptr<MobilityModel> model)
+    {
+        std::unordered_map<const MobilityModel *, uint32_t>::iterator it = m_index.find(PeekPointer(model));
+        if (it != m_index.end())
+        {
+            return it->second;
+        }
+        uint32_t index = m_generation.size();
+        m_index[PeekPointer(model)] = index;
+        m_generation.push_back(0);
+        model->TraceConnectWithoutContext("CourseChange", MakeCallback(&MobilityPairCache::NotifyCourseChange, this));
+        return index;
+    }
+
+    uint64_t MobilityPairCache::GetKey(uint32_t a, uint32_t b) const
+    {
+        return ((uint64_t)a << 32) | b;
+    }
+
+    void MobilityPairCache::NotifyCourseChange(Ptr<const MobilityModel> model)
+    {
+        std::unordered_map<const MobilityModel *, uint32_t>::iterator it = m_index.find(PeekPointer(model));
+        if (it != m_index.end())
+        {
+            m_generation[it->second]++;
+            s_stats.invalidations++;
+        }
+    }
+
+    bool MobilityPairCache::Lookup(Ptr<MobilityModel> a, Ptr<MobilityModel> b, double &value)
+    {
+        uint32_t indexA = GetIndex(a);
+        uint32_t indexB = GetIndex(b);
+        std::unordered_map<uint64_t, Entry>::const_iterator it = m_entries.find(GetKey(indexA, indexB));
+        if (it == m_entries.end() || it->second.generationA != m_generation[indexA] || it->second.generationB != m_generation[indexB])
+        {
+            s_stats.misses++;
+            return false;
+        }
+        s_stats.hits++;
+        value = it->second.value;
+        return true;
+    }
+
+    void MobilityPairCache::Store(Ptr<MobilityModel> a, Ptr<MobilityModel> b, double value)
+    {
+        uint32_t indexA = GetIndex(a);
+        uint32_t indexB = GetIndex(b);
+        Entry entry = {value, m_generation[indexA], m_generation[indexB]};
+        m_entries[GetKey(indexA, indexB)] = entry;
+    }
+
+    TypeId CachedPropagationLossModel::GetTypeId(void)
+    {
+        static TypeId tid = TypeId("ns3::CachedPropagationLossModel")
+                                .SetParent<PropagationLossModel>()
+                                .AddConstructor<CachedPropagationLossModel>()
+                                .AddAttribute("Model", "Modelo de perda determinístico cujos resultados são memorizados",
+                                              PointerValue(),
+                                              MakePointerAccessor(&CachedPropagationLossModel::m_model),
+                                              MakePointerChecker<PropagationLossModel>());
+        return tid;
+    }
+
+    CachedPropagationLossModel::CachedPropagationLossModel()
+    {
+        m_model = CreateObject<LogDistancePropagationLossModel>();
+    }
+
+    double CachedPropagationLossModel::DoCalcRxPower(double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+    {
+        double loss;
+        if (!m_cache.Lookup(a, b, loss))
+        {
+            loss = txPowerDbm - m_model->CalcRxPower(txPowerDbm, a, b);
+            m_cache.Store(a, b, loss);
+        }
+        return txPowerDbm - loss;
+    }
+
+    int64_t CachedPropagationLossModel::DoAssignStreams(int64_t stream)
+    {
+        return m_model->AssignStreams(stream);
+    }
+
+    TypeId CachedPropagationDelayModel::GetTypeId(void)
+    {
+        static TypeId tid = TypeId("ns3::CachedPropagationDelayModel")
+                                .SetParent<PropagationDelayModel>()
+                                .AddConstructor<CachedPropagationDelayModel>()
+                                .AddAttribute("Model", "Modelo de atraso determinístico cujos resultados são memorizados",
+                                              PointerValue(),
+                                              MakePointerAccessor(&CachedPropagationDelayModel::m_model),
+                                              MakePointerChecker<PropagationDelayModel>());
+        return tid;
+    }
+
+    CachedPropagationDelayModel::CachedPropagationDelayModel()
+    {
+        m_model = CreateObject<ConstantSpeedPropagationDelayModel>();
+    }
+
+    Time CachedPropagationDelayModel::GetDelay(Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+    {
+        double delay; // em unidades de Time, exatas em um double para qualquer atraso de propagação realista
+        if (!m_cache.Lookup(a, b, delay))
+        {
+            delay = m_model->GetDelay(a, b).GetTimeStep();
+            m_cache.Store(a, b, delay);
+        }
+        return TimeStep((uint64_t)delay);
+    }
+
+    int64_t CachedPropagationDelayModel::DoAssignStreams(int64_t stream)
+    {
+        return m_model->AssignStreams(stream);
+    }
+}
@@ -0,0 +1,179 @@
+#include "ns3/simulator.h"
+#include "include/event-log.h"
+
+namespace ns3
+{
+    EventLog::EventLog()
+    {
+        m_level = EVENT_LOG_NONE;
+        m_head = 0;
+        m_count = 0;
+        m_format = CSV;
+        m_logged = 0;
+        m_overwritten = 0;
+    }
+
+    EventLog::~EventLog()
+    {
+        Close();
+    }
+
+    bool EventLog::Configure(EventLogLevel level, uint32_t capacity, const std::string &path, Format format)
+    {
+        Close();
+        m_level = level;
+        m_format = format;
+        m_entries.assign(capacity > 0 ? capacity : 1, EventEntry());
+        m_head = 0;
+        m_count = 0;
+        m_logged = 0;
+        m_overwritten = 0;
+        if (path.empty() || level == EVENT_LOG_NONE)
+        {
+            return true;
+        }
+
+        m_out.open(path, std::ios::binary | std::ios::trunc);
+        if (!m_out)
+        {
+            return false;
+        }
+        if (m_format == BINARY)
+        {
+            char header[8] = {'W', 'H', 'E', 'V', (char)(VERSION & 0xff), (char)(VERSION >> 8),
+                              (char)(ENTRY_SIZE & 0xff), (char)(ENTRY_SIZE >> 8)};
+            m_out.write(header, sizeof(header));
+        }
+        else
+        {
+            m_out << "time_ns,node,type,source,dest,command,payload,size\n";
+        }
+        return true;
+    }
+
+    bool EventLog::IsEnabled(EventLogLevel level) const
+    {
+        return level <= m_level && m_level != EVENT_LOG_NONE;
+    }
+
+    void EventLog::LogPacket(uint32_t node, uint32_t size)
+    {
+        if (IsEnabled(EVENT_LOG_PACKETS))
+        {
+            Append(EVENT_PACKET, node, size, 0);
+        }
+    }
+
+    void EventLog::LogInvalidFrame(uint32_t node, uint32_t size)
+    {
+        if (IsEnabled(EVENT_LOG_PACKETS))
+        {
+            Append(EVENT_INVALID_FRAME, node, size, 0);
+        }
+    }
+
+    void EventLog::LogRecord(uint32_t node, const ShelfRecord &record)
+    {
+        if (IsEnabled(EVENT_LOG_RECORDS))
+        {
+            Append(EVENT_RECORD, node, 0, &record);
+        }
+    }
+
+    void EventLog::LogSentRecord(uint32_t node, const ShelfRecord &record)
+    {
+        if (IsEnabled(EVENT_LOG_RECORDS))
+        {
+            Append(EVENT_SENT_RECORD, node, 0, &record);
+        }
+    }
+
+    void EventLog::Append(uint8_t type, uint32_t node, uint32_t size, const ShelfRecord *record)
+    {
+        if (m_count == m_entries.size())
+        {
+            if (m_out.is_open())
+            {
+                Drain(); // buffer cheio: grava tudo de uma vez
+            }
+            else
+            {
+                m_head = (m_head + 1) % m_entries.size(); // sem arquivo, sobrescreve o mais antigo
+                m_count--;
+                m_overwritten++;
+            }
+        }
+
+        EventEntry &entry = m_entries[(m_head + m_count) % m_entries.size()];
+        entry.time = Simulator::Now().GetNanoSeconds();
+        entry.node = node;
+        entry.size = size;
+        entry.type = type;
+        entry.source = record ? record->source : 0;
+        entry.dest = record ? record->dest : 0;
+        entry.command = record ? record->command : 0;
+        entry.payload = record ? record->payload : 0;
+        m_count++;
+        m_logged++;
+    }
+
+    void EventLog::Write(const EventEntry &entry)
+    {
+        if (m_format == BINARY)
+        {
+            uint8_t bytes[ENTRY_SIZE];
+            for (uint32_t i = 0; i < 8; i++)
+            {
+                bytes[i] = (uint64_t)entry.time >> (8 * i);
+            }
+            for (uint32_t i = 0; i < 4; i++)
+            {
+                bytes[8 + i] = entry.node >> (8 * i);
+                bytes[12 + i] = entry.size >> (8 * i);
+            }
+            bytes[16] = entry.type;
+            for (uint32_t i = 0; i < 4; i++)
+            {
+                bytes[17 + i] = entry.source >> (8 * i);
+                bytes[21 + i] = entry.dest >> (8 * i);
+                bytes[26 + i] = entry.payload >> (8 * i);
+            }
+            bytes[25] = entry.command;
+            m_out.write((const char *)bytes, ENTRY_SIZE);
+        }
+        else
+        {
+            m_out << entry.time << ',' << entry.node << ',' << (uint32_t)entry.type << ',' << entry.source << ','
+                  << entry.dest << ',' << (uint32_t)entry.command << ',' << entry.payload << ',' << entry.size << '\n';
+        }
+    }
+
+    void EventLog::Drain()
+    {
+        for (uint32_t i = 0; i < m_count; i++)
+        {
+            Write(m_entries[(m_head + i) % m_entries.size()]);
+        }
+        m_head = 0;
+        m_count = 0;
+    }
+
+    void EventLog::Close()
+    {
+        if (m_out.is_open())
+        {
+            Drain();
+            m_out.close();
+        }
+    }
+
+    uint64_t EventLog::GetLogged() const
+    {
+        return m_logged;
+    }
+
+    uint64_t EventLog::GetOverwritten() const
+    {
+        return m_overwritten;
+    }
+}
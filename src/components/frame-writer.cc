@@ -0,0 +1,191 @@
+#include "ns3/log.h"
+#include "ns3/inet-socket-address.h"
+#include "include/frame-writer.h"
+#include <algorithm>
+
+namespace ns3
+{
+    NS_LOG_COMPONENT_DEFINE("FrameWriter");
+
+    WireStats FrameWriter::s_stats = {0, 0, 0};
+    static CodecAllocationStats s_allocationStats = {0, 0};
+
+    void CountCodecAllocation(uint64_t bytes)
+    {
+        s_allocationStats.allocations++;
+        s_allocationStats.bytes += bytes;
+    }
+
+    const CodecAllocationStats &GetCodecAllocationStats()
+    {
+        return s_allocationStats;
+    }
+
+    FrameWriter::FrameWriter()
+    {
+        m_port = 0;
+        m_sequence = 0;
+        m_nPending = 0;
+        m_metrics = 0;
+        m_packetsSent = 0;
+        m_bytesSent = 0;
+    }
+
+    FrameWriter::FrameWriter(Ptr<Socket> socket, uint16_t port, uint32_t maxPendingHops)
+    {
+        m_socket = socket;
+        m_port = port;
+        m_sequence = 0;
+        m_pending.resize(maxPendingHops);
+        m_nPending = 0;
+        m_metrics = 0;
+        m_packetsSent = 0;
+        m_bytesSent = 0;
+    }
+
+    void FrameWriter::Append(Ipv4Address nextHop, const ShelfRecord &record)
+    {
+        Append(nextHop, record, LatencyTag()); // registro gerado por este nó, origem agora
+    }
+
+    void FrameWriter::Append(Ipv4Address nextHop, const ShelfRecord &record, const LatencyTag &origin)
+    {
+        PendingFrame *frame = 0;
+        for (uint32_t i = 0; i < m_nPending; i++)
+        {
+            if (m_pending[i].nextHop == nextHop)
+            {
+                frame = &m_pending[i];
+                break;
+            }
+        }
+        if (frame == 0)
+        {
+            if (m_nPending == m_pending.size())
+            {
+                Flush();
+            }
+            frame = &m_pending[m_nPending++];
+            frame->nextHop = nextHop;
+            frame->recordCount = 0;
+            frame->size = FRAME_HEADER_SIZE;
+        }
+        uint32_t recordSize = GetRecordSize(record);
+        if (frame->size + recordSize > MAX_FRAME_SIZE) // registros de tamanho variável: o quadro pode encher antes de MAX_RECORDS_PER_FRAME
+        {
+            Send(*frame);
+        }
+        if (frame->recordCount == 0 || origin.GetOrigin() < frame->origin)
+        {
+            frame->origin = origin.GetOrigin();
+        }
+        if (frame->recordCount == 0 || origin.GetHops() > frame->hops)
+        {
+            frame->hops = origin.GetHops();
+        }
+
+        frame->size += EncodeRecord(record, frame->bytes + frame->size);
+        frame->recordCount++;
+        if (frame->recordCount == MAX_RECORDS_PER_FRAME)
+        {
+            Send(*frame);
+        }
+    }
+
+    void FrameWriter::Flush()
+    {
+        for (uint32_t i = 0; i < m_nPending; i++)
+        {
+            if (m_pending[i].recordCount > 0)
+            {
+                Send(m_pending[i]);
+            }
+        }
+        m_nPending = 0;
+    }
+
+    void FrameWriter::AddBroadcastAddress(Ipv4Address address)
+    {
+        m_broadcasts.push_back(address);
+    }
+
+    bool FrameWriter::IsBroadcast(Ipv4Address address) const
+    {
+        return address.IsBroadcast() || std::find(m_broadcasts.begin(), m_broadcasts.end(), address) != m_broadcasts.end();
+    }
+
+    void FrameWriter::Send(PendingFrame &frame)
+    {
+        NS_LOG_FUNCTION(this << frame.nextHop << frame.recordCount);
+        FrameHeader header;
+        bool broadcast = IsBroadcast(frame.nextHop);
+        bool reliable = m_arq && m_arq->IsEnabled() && !broadcast;
+        header.flags = broadcast ? FRAME_FLAG_BROADCAST : 0;
+        if (reliable) // a confirmação cumulativa exige números consecutivos por vizinho
+        {
+            header.flags |= FRAME_FLAG_RELIABLE;
+            header.sequence = m_arq->NextSequence(frame.nextHop);
+        }
+        else
+        {
+            header.sequence = m_sequence++;
+        }
+        header.recordCount = frame.recordCount;
+        EncodeFrameHeader(header, frame.bytes);
+
+        uint32_t size = frame.size;
+        LatencyTag tag(frame.origin, frame.hops + 1);
+        Ptr<Packet> packet = Create<Packet>(frame.bytes, size);
+        packet->AddPacketTag(tag);
+        m_socket->SendTo(packet, 0, InetSocketAddress(frame.nextHop, m_port));
+        if (reliable)
+        {
+            m_arq->OnSent(frame.nextHop, header.sequence, frame.bytes, size, tag);
+        }
+
+        s_stats.datagrams++;
+        s_stats.records += frame.recordCount;
+        s_stats.payloadBytes += size;
+        if (m_metrics)
+        {
+            m_metrics->Increment(m_packetsSent);
+            m_metrics->Increment(m_bytesSent, size);
+        }
+        frame.recordCount = 0;
+        frame.size = FRAME_HEADER_SIZE;
+    }
+
+    void FrameWriter::SetArq(Ptr<ArqEndpoint> arq)
+    {
+        m_arq = arq;
+    }
+
+    void FrameWriter::SetMetrics(MetricsRegistry *metrics, const NodeMetrics &ids)
+    {
+        m_metrics = metrics;
+        m_packetsSent = ids.packetsSent;
+        m_bytesSent = ids.bytesSent;
+    }
+
+    const WireStats &FrameWriter::GetStats()
+    {
+        return s_stats;
+    }
+
+    uint32_t FrameWriter::GetMemoryUsage() const
+    {
+        return m_pending.capacity() * sizeof(PendingFrame);
+    }
+
+    bool ReadFrame(Ptr<Packet> packet, WarehouseFrame &frame)
+    {
+        uint32_t size = packet->GetSize();
+        if (size > MAX_FRAME_SIZE)
+        {
+            return false;
+        }
+        uint8_t buffer[MAX_FRAME_SIZE];
+        packet->CopyData(buffer, size);
+        return DecodeFrame(buffer, size, frame);
+    }
+}
@@ -0,0 +1,340 @@
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/inet-socket-address.h"
+#include "include/gateway-client-application.h"
+
+namespace ns3
+{
+    NS_LOG_COMPONENT_DEFINE("GatewayClientApplication");
+    NS_OBJECT_ENSURE_REGISTERED(GatewayClientApplication);
+
+    GatewayClientStats GatewayClientApplication::s_stats = {0, 0, 0, 0, Time(), Time()};
+
+    TypeId GatewayClientApplication::GetTypeId(void)
+    {
+        static TypeId tid = TypeId("ns3::GatewayClientApplication")
+                                .SetParent<Application>()
+                                .AddConstructor<GatewayClientApplication>()
+                                .AddAttribute("Port", "Porta em que o gateway recebe e envia quadros",
+                                              UintegerValue(5500),
+                                              MakeUintegerAccessor(&GatewayClientApplication::m_port),
+                                              MakeUintegerChecker<uint16_t>())
+                                .AddAttribute("RelayAddress", "Endereço do intermediário entre gateway e servidor",
+                                              Ipv4AddressValue(),
+                                              MakeIpv4AddressAccessor(&GatewayClientApplication::m_relayAddress),
+                                              MakeIpv4AddressChecker())
+                                .AddAttribute("Window", "Comandos pendentes ao mesmo tempo; zero envia um comando a cada Interval",
+                                              UintegerValue(0),
+                                              MakeUintegerAccessor(&GatewayClientApplication::m_window),
+                                              MakeUintegerChecker<uint32_t>())
+                                .AddAttribute("Interval", "Intervalo entre comandos quando Window é zero",
+                                              TimeValue(Seconds(1)),
+                                              MakeTimeAccessor(&GatewayClientApplication::m_interval),
+                                              MakeTimeChecker())
+                                .AddAttribute("MaxCommands", "Comandos a enviar; zero envia todos os comandos da fonte",
+                                              UintegerValue(0),
+                                              MakeUintegerAccessor(&GatewayClientApplication::m_maxCommands),
+                                              MakeUintegerChecker<uint32_t>())
+                                .AddAttribute("CommandTimeout", "Prazo para a resposta de um comando, após o qual ele é dado como perdido",
+                                              TimeValue(Seconds(1)),
+                                              MakeTimeAccessor(&GatewayClientApplication::m_commandTimeout),
+                                              MakeTimeChecker())
+                                .AddAttribute("Reliable", "Envia os comandos com confirmação e reenvio",
+                                              BooleanValue(false),
+                                              MakeBooleanAccessor(&GatewayClientApplication::m_reliable),
+                                              MakeBooleanChecker());
+        return tid;
+    }
+
+    TypeId GatewayClientApplication::GetInstanceTypeId(void) const
+    {
+        return GatewayClientApplication::GetTypeId();
+    }
+
+    GatewayClientApplication::GatewayClientApplication()
+    {
+        m_port = 5500;
+        m_window = 0;
+        m_maxCommands = 0;
+        m_reliable = false;
+        m_issued = 0;
+        m_log = 0;
+        m_latency = 0;
+        m_metrics = 0;
+    }
+
+    GatewayClientApplication::~GatewayClientApplication()
+    {
+    }
+
+    void GatewayClientApplication::SetCommandSource(Ptr<GatewayCommandSource> source)
+    {
+        m_source = source;
+    }
+
+    void GatewayClientApplication::SetEventLog(EventLog *log)
+    {
+        m_log = log;
+    }
+
+    void GatewayClientApplication::SetMetrics(MetricsRegistry *metrics)
+    {
+        m_metrics = metrics;
+    }
+
+    void GatewayClientApplication::SetLatencyCollector(LatencyCollector *latency)
+    {
+        m_latency = latency;
+    }
+
+    void GatewayClientApplication::StartApplication()
+    {
+        NS_LOG_FUNCTION(this);
+        TypeId tid = TypeId::LookupByName("ns3::UdpSocketFactory");
+        m_socket = Socket::CreateSocket(GetNode(), tid);
+        if (m_socket->Bind(InetSocketAddress(Ipv4Address::GetAny(), m_port)) == -1)
+        {
+            NS_FATAL_ERROR("Failed to bind socket");
+        }
+        m_socket->SetRecvCallback(MakeCallback(&GatewayClientApplication::HandleRead, this));
+        m_socket->SetRecvPktInfo(true);
+        m_writer = FrameWriter(m_socket, m_port, 1); // o gateway só envia para o seu intermediário
+        m_arq = Create<ArqEndpoint>(m_socket, m_port, m_reliable);
+        m_writer.SetArq(m_arq);
+        if (m_metrics)
+        {
+            m_metricIds = m_metrics->AddNode(GetNode()->GetId(), "gateway");
+            m_outstandingGauge = m_metrics->AddGauge(GetNode()->GetId(), "outstanding");
+            m_writer.SetMetrics(m_metrics, m_metricIds);
+        }
+        StartSending();
+    }
+
+    void GatewayClientApplication::StartSending()
+    {
+        if (m_window == 0)
+        {
+            PacedIssue();
+        }
+        else
+        {
+            FillWindow();
+        }
+    }
+
+    void GatewayClientApplication::StopApplication()
+    {
+        NS_LOG_FUNCTION(this);
+        Simulator::Cancel(m_sendEvent);
+        Simulator::Cancel(m_expiryEvent);
+        if (m_arq)
+        {
+            m_arq->Close();
+        }
+        if (m_socket)
+        {
+            m_socket->Close();
+            m_socket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
+        }
+    }
+
+    void GatewayClientApplication::DoDispose()
+    {
+        m_socket = 0;
+        m_writer = FrameWriter();
+        m_arq = 0;
+        m_source = 0;
+        Application::DoDispose();
+    }
+
+    bool GatewayClientApplication::IssueNext()
+    {
+        if (!m_source || !m_source->HasNext() || (m_maxCommands > 0 && m_issued == m_maxCommands))
+        {
+            NS_LOG_INFO("Log do gateway esvaziado. Não há mais comandos a enviar.");
+            if (m_metrics)
+            {
+                m_metrics->Increment(m_metricIds.logExhausted);
+            }
+            return false;
+        }
+        ShelfRecord record;
+        record.source = GATEWAY_ID; // Gateway
+        record.dest = SERVER_ID; // Server
+        m_source->Next(record.command, record.payload); // comando a executar e prateleira alvo, no payload
+        m_writer.Append(m_relayAddress, record);
+        m_writer.Flush();
+
+        if (s_stats.issued == 0)
+        {
+            s_stats.firstIssue = Simulator::Now();
+        }
+        s_stats.issued++;
+        m_issued++;
+        m_outstanding.push_back(Simulator::Now());
+        if (m_metrics)
+        {
+            m_metrics->Set(m_outstandingGauge, m_outstanding.size());
+        }
+        if (!m_expiryEvent.IsRunning())
+        {
+            ScheduleExpiry();
+        }
+        return true;
+    }
+
+    void GatewayClientApplication::PacedIssue()
+    {
+        if (IssueNext())
+        {
+            m_sendEvent = Simulator::Schedule(m_interval, &GatewayClientApplication::PacedIssue, this);
+        }
+    }
+
+    void GatewayClientApplication::FillWindow()
+    {
+        while (m_window > 0 && m_outstanding.size() < m_window && IssueNext())
+        {
+        }
+    }
+
+    void GatewayClientApplication::ScheduleExpiry()
+    {
+        if (!m_outstanding.empty())
+        {
+            m_expiryEvent = Simulator::Schedule(m_outstanding.front() + m_commandTimeout - Simulator::Now(),
+                                                &GatewayClientApplication::ExpireCommands, this);
+        }
+    }
+
+    void GatewayClientApplication::ExpireCommands()
+    {
+        while (!m_outstanding.empty() && m_outstanding.front() + m_commandTimeout <= Simulator::Now())
+        {
+            NS_LOG_INFO("Comando do gateway sem resposta em " << m_commandTimeout.GetSeconds() << " s.");
+            m_outstanding.pop_front();
+            s_stats.timedOut++;
+        }
+        if (m_metrics)
+        {
+            m_metrics->Set(m_outstandingGauge, m_outstanding.size());
+        }
+        ScheduleExpiry();
+        FillWindow();
+    }
+
+    void GatewayClientApplication::HandleRead(Ptr<Socket> socket)
+    {
+        NS_LOG_FUNCTION(this << socket);
+        Ptr<Packet> packet;
+        Address from;
+        while ((packet = socket->RecvFrom(from)))
+        {
+            uint32_t packetSize = packet->GetSize();
+            Ipv4Address senderAddress = InetSocketAddress::ConvertFrom(from).GetIpv4();
+            if (m_log)
+            {
+                m_log->LogPacket(GetNode()->GetId(), packetSize);
+            }
+            if (m_metrics)
+            {
+                m_metrics->OnPacket(m_metricIds, packetSize);
+            }
+
+            WarehouseFrame frame;
+            if (!ReadFrame(packet, frame)) // quadro com versão desconhecida ou tamanho inconsistente
+            {
+                NS_LOG_INFO("Quadro inválido descartado pelo gateway.");
+                if (m_log)
+                {
+                    m_log->LogInvalidFrame(GetNode()->GetId(), packetSize);
+                }
+                if (m_metrics)
+                {
+                    m_metrics->Increment(m_metricIds.invalidFrames);
+                }
+                continue;
+            }
+            if (frame.header.flags & FRAME_FLAG_BROADCAST) // verificação em difusão destinada aos sensores
+            {
+                continue;
+            }
+            if (!m_arq->Receive(senderAddress, frame.header, packetSize)) // confirmação ou quadro repetido
+            {
+                continue;
+            }
+            LatencyTag origin;
+            packet->PeekPacketTag(origin);
+
+            for (uint16_t r = 0; r < frame.header.recordCount; r++)
+            {
+                const ShelfRecord &data = frame.records[r];
+                if (m_latency)
+                {
+                    m_latency->Record(data.command, origin.GetElapsed(), origin.GetHops()); // resposta ao comando emitido pelo gateway
+                }
+                bool reply = false;
+                switch (data.command)
+                {
+                case COMMAND_EMPTY:
+                    NS_LOG_INFO("Produto dispachado com sucesso");
+                    reply = true;
+                    break;
+                case COMMAND_FILL:
+                    NS_LOG_INFO("Produto armazenado com sucesso");
+                    reply = true;
+                    break;
+                case COMMAND_ERROR:
+                    if (data.payload == ERROR_INCONSISTENT)
+                        NS_LOG_INFO("Inconsistência de valores, alertando central");
+                    else if (data.payload == ERROR_SHELF_FULL)
+                        NS_LOG_INFO("Tentativa de armazenar produto em prateleira ocupada");
+                    else if (data.payload == ERROR_SHELF_EMPTY)
+                        NS_LOG_INFO("Tentativa de retirar produto de prateleira vazia");
+                    reply = data.payload != ERROR_INCONSISTENT; // os demais erros respondem a um comando do gateway
+                    break;
+                default:
+                    break;
+                }
+
+                if (reply)
+                {
+                    if (m_outstanding.empty()) // o comando já tinha sido dado como perdido
+                    {
+                        s_stats.late++;
+                    }
+                    else
+                    {
+                        m_outstanding.pop_front();
+                        s_stats.completed++;
+                        s_stats.lastCompletion = Simulator::Now();
+                    }
+                }
+                if (m_log)
+                {
+                    m_log->LogRecord(GetNode()->GetId(), data);
+                }
+                if (m_metrics)
+                {
+                    m_metrics->OnRecord(m_metricIds, data);
+                }
+            }
+            if (m_outstanding.empty())
+            {
+                Simulator::Cancel(m_expiryEvent);
+            }
+            if (m_metrics)
+            {
+                m_metrics->Set(m_outstandingGauge, m_outstanding.size());
+            }
+            FillWindow();
+        }
+    }
+
+    const GatewayClientStats &GatewayClientApplication::GetStats()
+    {
+        return s_stats;
+    }
+}
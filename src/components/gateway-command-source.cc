@@ -0,0 +1,133 @@
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "include/gateway-command-source.h"
+#include "include/warehouse-protocol.h"
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace ns3
+{
+    GatewayCommandSource::~GatewayCommandSource()
+    {
+    }
+
+    InstanceCommandSource::InstanceCommandSource(RowCursor commands, RowCursor targets)
+    {
+        m_commands = commands;
+        m_targets = targets;
+    }
+
+    bool InstanceCommandSource::HasNext() const
+    {
+        return m_commands.HasNext() && m_targets.HasNext();
+    }
+
+    void InstanceCommandSource::Next(uint8_t &command, uint32_t &target)
+    {
+        command = m_commands.Next();
+        target = m_targets.Next();
+    }
+
+    RandomCommandSource::RandomCommandSource(uint32_t shelves, double fillRatio, double zipfExponent)
+    {
+        m_shelves = shelves;
+        m_fillRatio = fillRatio;
+        m_command = CreateObject<UniformRandomVariable>();
+        if (zipfExponent > 0)
+        {
+            m_zipf = CreateObject<ZipfRandomVariable>();
+            m_zipf->SetAttribute("N", UintegerValue(shelves));
+            m_zipf->SetAttribute("Alpha", DoubleValue(zipfExponent));
+        }
+        else
+        {
+            m_uniform = CreateObject<UniformRandomVariable>();
+        }
+    }
+
+    bool RandomCommandSource::HasNext() const
+    {
+        return true;
+    }
+
+    void RandomCommandSource::Next(uint8_t &command, uint32_t &target)
+    {
+        command = m_command->GetValue() < m_fillRatio ? COMMAND_FILL : COMMAND_EMPTY;
+        target = m_zipf ? m_zipf->GetInteger() : m_uniform->GetInteger(1, m_shelves);
+    }
+
+    TraceCommandSource::TraceCommandSource()
+    {
+        m_next = 0;
+    }
+
+    bool TraceCommandSource::Load(const std::string &path)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            m_error = std::strerror(errno);
+            return false;
+        }
+        m_entries.clear();
+        m_next = 0;
+        std::string line;
+        uint32_t lineNumber = 0;
+        while (std::getline(file, line))
+        {
+            lineNumber++;
+            std::istringstream fields(line);
+            double seconds;
+            uint32_t command, target;
+            if (!(fields >> seconds)) // linha vazia ou comentário
+            {
+                if (line.find_first_not_of(" \t\r") == std::string::npos || line[line.find_first_not_of(" \t\r")] == '#')
+                {
+                    continue;
+                }
+                m_error = "linha " + std::to_string(lineNumber) + " mal formada";
+                return false;
+            }
+            if (!(fields >> command >> target) || command > 255 || target > NODE_INDEX_MASK || seconds < 0)
+            {
+                m_error = "linha " + std::to_string(lineNumber) + " mal formada";
+                return false;
+            }
+            Entry entry;
+            entry.time = Seconds(seconds);
+            entry.command = command;
+            entry.target = target;
+            if (!m_entries.empty() && entry.time < m_entries.back().time)
+            {
+                m_error = "linha " + std::to_string(lineNumber) + " fora de ordem";
+                return false;
+            }
+            m_entries.push_back(entry);
+        }
+        return true;
+    }
+
+    const std::string &TraceCommandSource::GetError() const
+    {
+        return m_error;
+    }
+
+    bool TraceCommandSource::HasNext() const
+    {
+        return m_next < m_entries.size();
+    }
+
+    void TraceCommandSource::Next(uint8_t &command, uint32_t &target)
+    {
+        command = m_entries[m_next].command;
+        target = m_entries[m_next].target;
+        m_next++;
+    }
+
+    Time TraceCommandSource::PeekTime() const
+    {
+        return m_entries[m_next].time;
+    }
+}
@@ -0,0 +1,155 @@
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/simulator.h"
+#include "include/gateway-load-generator.h"
+
+namespace ns3
+{
+    NS_LOG_COMPONENT_DEFINE("GatewayLoadGenerator");
+    NS_OBJECT_ENSURE_REGISTERED(GatewayLoadGenerator);
+
+    TypeId GatewayLoadGenerator::GetTypeId(void)
+    {
+        static TypeId tid = TypeId("ns3::GatewayLoadGenerator")
+                                .SetParent<GatewayClientApplication>()
+                                .AddConstructor<GatewayLoadGenerator>()
+                                .AddAttribute("Arrival", "Processo de chegada dos comandos",
+                                              EnumValue(GatewayLoadGenerator::POISSON),
+                                              MakeEnumAccessor(&GatewayLoadGenerator::m_arrival),
+                                              MakeEnumChecker(GatewayLoadGenerator::POISSON, "Poisson",
+                                                              GatewayLoadGenerator::ON_OFF, "OnOff",
+                                                              GatewayLoadGenerator::TRACE, "Trace"))
+                                .AddAttribute("Rate", "Comandos por segundo (durante os períodos ativos, no modo OnOff)",
+                                              DoubleValue(10),
+                                              MakeDoubleAccessor(&GatewayLoadGenerator::m_rate),
+                                              MakeDoubleChecker<double>(0))
+                                .AddAttribute("OnTime", "Duração média de um período ativo no modo OnOff",
+                                              TimeValue(Seconds(1)),
+                                              MakeTimeAccessor(&GatewayLoadGenerator::m_onTime),
+                                              MakeTimeChecker())
+                                .AddAttribute("OffTime", "Duração média de um silêncio no modo OnOff",
+                                              TimeValue(Seconds(1)),
+                                              MakeTimeAccessor(&GatewayLoadGenerator::m_offTime),
+                                              MakeTimeChecker())
+                                .AddAttribute("Shelves", "Prateleiras sorteadas como alvo, de 1 a Shelves",
+                                              UintegerValue(1),
+                                              MakeUintegerAccessor(&GatewayLoadGenerator::m_shelves),
+                                              MakeUintegerChecker<uint32_t>(1))
+                                .AddAttribute("FillRatio", "Probabilidade de um comando sorteado ser de preencher, e não de esvaziar",
+                                              DoubleValue(0.5),
+                                              MakeDoubleAccessor(&GatewayLoadGenerator::m_fillRatio),
+                                              MakeDoubleChecker<double>(0, 1))
+                                .AddAttribute("ZipfExponent", "Expoente da distribuição de Zipf dos alvos; zero sorteia os alvos uniformemente",
+                                              DoubleValue(0),
+                                              MakeDoubleAccessor(&GatewayLoadGenerator::m_zipfExponent),
+                                              MakeDoubleChecker<double>(0));
+        return tid;
+    }
+
+    TypeId GatewayLoadGenerator::GetInstanceTypeId(void) const
+    {
+        return GatewayLoadGenerator::GetTypeId();
+    }
+
+    GatewayLoadGenerator::GatewayLoadGenerator()
+    {
+        m_arrival = POISSON;
+        m_rate = 10;
+        m_shelves = 1;
+        m_fillRatio = 0.5;
+        m_zipfExponent = 0;
+        m_gap = CreateObject<ExponentialRandomVariable>();
+        m_on = CreateObject<ExponentialRandomVariable>();
+        m_off = CreateObject<ExponentialRandomVariable>();
+    }
+
+    GatewayLoadGenerator::~GatewayLoadGenerator()
+    {
+    }
+
+    void GatewayLoadGenerator::SetTrace(Ptr<TraceCommandSource> trace)
+    {
+        m_trace = trace;
+    }
+
+    void GatewayLoadGenerator::DoDispose()
+    {
+        m_trace = 0;
+        m_gap = 0;
+        m_on = 0;
+        m_off = 0;
+        GatewayClientApplication::DoDispose();
+    }
+
+    void GatewayLoadGenerator::StartSending()
+    {
+        m_start = Simulator::Now();
+        if (m_arrival == TRACE)
+        {
+            if (!m_trace)
+            {
+                NS_FATAL_ERROR("Arrival=Trace requires SetTrace()");
+            }
+            m_source = m_trace;
+        }
+        else
+        {
+            if (m_rate <= 0)
+            {
+                return;
+            }
+            if (m_arrival == ON_OFF && !m_onTime.IsStrictlyPositive())
+            {
+                NS_FATAL_ERROR("Arrival=OnOff requires a positive OnTime");
+            }
+            if (!m_source)
+            {
+                m_source = Create<RandomCommandSource>(m_shelves, m_fillRatio, m_zipfExponent);
+            }
+            m_gap->SetAttribute("Mean", DoubleValue(1.0 / m_rate));
+            m_on->SetAttribute("Mean", DoubleValue(m_onTime.GetSeconds()));
+            m_off->SetAttribute("Mean", DoubleValue(m_offTime.GetSeconds()));
+            m_onUntil = m_start + Seconds(m_on->GetValue());
+        }
+        ScheduleNext();
+    }
+
+    void GatewayLoadGenerator::Arrive()
+    {
+        if (IssueNext())
+        {
+            ScheduleNext();
+        }
+    }
+
+    void GatewayLoadGenerator::ScheduleNext()
+    {
+        Time next;
+        switch (m_arrival)
+        {
+        case TRACE:
+            if (!m_trace->HasNext())
+            {
+                return;
+            }
+            next = m_start + m_trace->PeekTime();
+            break;
+        case ON_OFF:
+            next = Simulator::Now() + Seconds(m_gap->GetValue());
+            while (next > m_onUntil) // a chegada cairia no silêncio: começa um novo período ativo
+            {
+                Time onStart = m_onUntil + Seconds(m_off->GetValue());
+                m_onUntil = onStart + Seconds(m_on->GetValue());
+                next = onStart + Seconds(m_gap->GetValue()); // sem memória: o intervalo recomeça no início do período
+            }
+            break;
+        default:
+            next = Simulator::Now() + Seconds(m_gap->GetValue());
+            break;
+        }
+        Time delay = next > Simulator::Now() ? next - Simulator::Now() : Seconds(0);
+        m_sendEvent = Simulator::Schedule(delay, &GatewayLoadGenerator::Arrive, this);
+    }
+}
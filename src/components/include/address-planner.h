@@ -0,0 +1,91 @@
+#ifndef ADDRESS_PLANNER_H
+#define ADDRESS_PLANNER_H
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv4-interface-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/node.h"
+#include "warehouse-protocol.h"
+#include <vector>
+
+namespace ns3
+{
+    /** \brief Plano de endereços hierárquico do armazém, no lugar de uma única rede /24 para todos os nós.
+     *
+     * O armazém ocupa uma rede /8 (10.0.0.0/8 por padrão), dividida em blocos /16: o bloco 0 fica com os nós
+     * de infraestrutura (servidores, intermediários e gateway) e o corredor a com o bloco a + 1. Cada bloco é
+     * dividido em sub-redes /20 por papel (WarehouseNodeRole), de até MAX_SUBNET_HOSTS endereços; as prateleiras
+     * do corredor 0, por exemplo, ficam em 10.1.0.0/20 e o servidor em 10.0.16.0/20.
+     *
+     * Como os blocos são alinhados, um nó alcança todo o armazém com uma única rota (AddSiteRoutes) e um corredor
+     * inteiro com uma rota (AddAisleRoute), em vez de uma rota por nó calculada pelo roteamento global.
+     */
+    class AddressPlanner
+    {
+        public:
+            /** Corredores que cabem na rede do armazém, além do bloco de infraestrutura */
+            static const uint32_t MAX_AISLES = 255;
+            /** Endereços por sub-rede /20, sem a rede e o broadcast */
+            static const uint32_t MAX_SUBNET_HOSTS = 4094;
+
+            AddressPlanner();
+
+            /** \brief Usa a rede /8 que contém site no lugar de 10.0.0.0/8.
+             */
+            AddressPlanner(Ipv4Address site);
+
+            /** \brief Endereça devices na sub-rede do papel role no corredor aisle (a partir de 0), continuando de
+             * onde a chamada anterior para a mesma sub-rede parou. Interrompe a simulação se a sub-rede encher.
+             */
+            Ipv4InterfaceContainer AssignAisle (const NetDeviceContainer &devices, uint32_t aisle, uint32_t role = ROLE_SHELF);
+
+            /** \brief Endereça devices na sub-rede de infraestrutura do papel role.
+             */
+            Ipv4InterfaceContainer AssignInfrastructure (const NetDeviceContainer &devices, uint32_t role);
+
+            Ipv4Address GetSiteNetwork () const;
+            Ipv4Mask GetSiteMask () const;
+
+            /** \brief Rede /16 do corredor aisle.
+             */
+            Ipv4Address GetAisleNetwork (uint32_t aisle) const;
+            Ipv4Mask GetAisleMask () const;
+
+            /** \brief Rede /20 do papel role no corredor aisle.
+             */
+            Ipv4Address GetSubnet (uint32_t aisle, uint32_t role) const;
+
+            /** \brief Endereço de broadcast da sub-rede do papel role no corredor aisle.
+             */
+            Ipv4Address GetSubnetBroadcast (uint32_t aisle, uint32_t role) const;
+
+            /** \brief Sub-redes que já receberam algum endereço.
+             */
+            uint32_t GetSubnetCount () const;
+
+            /** \brief Dá a cada interface de interfaces uma rota direta (sem gateway) para todo o armazém, para
+             * nós que compartilham um mesmo meio: o ARP resolve qualquer endereço do armazém no enlace.
+             */
+            void AddSiteRoutes (const Ipv4InterfaceContainer &interfaces) const;
+
+            /** \brief Dá a cada interface de interfaces uma rota para todo o armazém por nextHop, como a dos sensores
+             * pelo ponto de acesso do seu corredor.
+             */
+            void AddSiteRoutes (const Ipv4InterfaceContainer &interfaces, Ipv4Address nextHop) const;
+
+            /** \brief Rota agregada do nó node para o corredor aisle, por nextHop na interface interface.
+             */
+            void AddAisleRoute (Ptr<Node> node, uint32_t aisle, Ipv4Address nextHop, uint32_t interface) const;
+
+        private:
+            /** \brief Endereça devices na sub-rede block (0 = infraestrutura) do papel role.
+             */
+            Ipv4InterfaceContainer Assign (const NetDeviceContainer &devices, uint32_t block, uint32_t role);
+
+            Ipv4Address GetBlockSubnet (uint32_t block, uint32_t role) const;
+
+            uint32_t m_site; /**< Rede do armazém, com os 24 bits baixos zerados */
+            std::vector<uint32_t> m_assigned; /**< Endereços já usados por sub-rede, índice bloco * NODE_ROLES + papel */
+    };
+}
+
+#endif
@@ -0,0 +1,161 @@
+#ifndef AISLE_TOPOLOGY_HELPER_H
+#define AISLE_TOPOLOGY_HELPER_H
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/ipv4-interface-container.h"
+#include "ns3/yans-wifi-helper.h"
+#include "ns3/wifi-phy-band.h"
+#include "ns3/nstime.h"
+#include "address-planner.h"
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+    /** \brief Monta a topologia de corredores do armazém: um ponto de acesso por corredor, com a sua própria
+     * rede Wi-Fi (SSID) para os sensores das prateleiras do corredor, e um backhaul cabeado até a infraestrutura.
+     *
+     * A infraestrutura (servidores, intermediário do gateway, intermediário dos sensores e gateway) fica em uma
+     * rede local CSMA. Com BACKHAUL_CSMA os pontos de acesso entram nessa mesma rede; com BACKHAUL_P2P cada ponto
+     * de acesso tem um enlace ponto a ponto com o intermediário dos sensores, que passa a ser o núcleo da rede.
+     *
+     * Os endereços vêm de um AddressPlanner: cada corredor ocupa o seu bloco /16, com o ponto de acesso no primeiro
+     * endereço da sub-rede das prateleiras, e as rotas são agregadas, uma por corredor nos nós da infraestrutura
+     * e uma para todo o armazém nos sensores e pontos de acesso. Todos os nós recebem posição fixa: os corredores
+     * ficam lado a lado em x, com o ponto de acesso na entrada e as prateleiras em pares empilhados ao longo de y.
+     *
+     * Cada célula recebe um número de canal 802.11 por coloração gulosa do grafo de interferência, em que dois
+     * pontos de acesso são vizinhos se estão a até InterferenceRange metros: o corredor fica com o primeiro canal
+     * que nenhum vizinho já usa ou, se todos estiverem em uso, com aquele cujo vizinho mais próximo está mais longe.
+     * As células de um mesmo canal compartilham um objeto YansWifiChannel e disputam o meio; as de canais distintos
+     * ficam em objetos separados, como canais sem sobreposição que não se ouvem.
+     */
+    class AisleTopologyHelper
+    {
+        public:
+            enum Backhaul
+            {
+                BACKHAUL_CSMA,
+                BACKHAUL_P2P
+            };
+
+            /** \brief Topologia com shelves prateleiras em corredores de até shelvesPerAisle prateleiras.
+             */
+            AisleTopologyHelper(uint32_t shelves, uint32_t shelvesPerAisle);
+
+            void SetServers (uint32_t servers);
+
+            /** \brief Tipo, taxa (ex.: "100Mbps") e atraso dos enlaces cabeados.
+             */
+            void SetBackhaul (Backhaul backhaul, std::string dataRate, Time delay);
+
+            /** \brief Distância entre corredores, entre pares de prateleiras e altura da prateleira de cima de cada par, em metros.
+             */
+            void SetLayout (double aisleSpacing, double shelfSpacing, double shelfHeight);
+
+            /** \brief Canais disponíveis para as células, na banda band e com largura width (MHz), em ordem de preferência.
+             */
+            void SetChannels (WifiPhyBand band, uint16_t width, const std::vector<uint8_t> &channels);
+
+            /** \brief Distância entre pontos de acesso, em metros, abaixo da qual as suas células não devem repetir o canal.
+             */
+            void SetInterferenceRange (double range);
+
+            /** \brief Canais 802.11 sem sobreposição da banda band com largura width, ou nenhum se a largura não existir na banda.
+             */
+            static std::vector<uint8_t> GetNonOverlappingChannels (WifiPhyBand band, uint16_t width);
+
+            /** \brief Cria os nós, dispositivos, endereços e rotas. As células usam os dispositivos de wifi e phy,
+             * com um canal criado por channel para cada número de canal atribuído.
+             */
+            void Build (const WifiHelper &wifi, YansWifiPhyHelper phy, const YansWifiChannelHelper &channel, AddressPlanner &planner);
+
+            uint32_t GetAisleCount () const;
+
+            /** \brief Corredor da prateleira de índice shelf (a partir de 0).
+             */
+            uint32_t GetAisle (uint32_t shelf) const;
+
+            const NodeContainer &GetSensors () const;
+            const NodeContainer &GetAccessPoints () const;
+            const NodeContainer &GetServers () const;
+
+            /** \brief Intermediários: 0 entre gateway e servidor, 1 entre servidor e sensores.
+             */
+            const NodeContainer &GetRelays () const;
+            const NodeContainer &GetGateway () const;
+
+            const Ipv4InterfaceContainer &GetSensorInterfaces () const;
+            const Ipv4InterfaceContainer &GetServerInterfaces () const;
+            const Ipv4InterfaceContainer &GetRelayInterfaces () const;
+            const Ipv4InterfaceContainer &GetGatewayInterfaces () const;
+
+            /** \brief Número do canal 802.11 da célula do corredor aisle.
+             */
+            uint8_t GetChannelNumber (uint32_t aisle) const;
+
+            /** \brief Canais distintos usados pelas células.
+             */
+            uint32_t GetChannelCount () const;
+
+            /** \brief Dispositivos Wi-Fi da célula do corredor aisle: o ponto de acesso seguido dos sensores.
+             */
+            const NetDeviceContainer &GetCellDevices (uint32_t aisle) const;
+
+            /** \brief Endereço do ponto de acesso do corredor aisle na sua célula, usado pelos sensores.
+             */
+            Ipv4Address GetAccessPointAddress (uint32_t aisle) const;
+
+            /** \brief Endereço do ponto de acesso do corredor aisle no backhaul, usado pelo intermediário dos sensores.
+             */
+            Ipv4Address GetAccessPointUplinkAddress (uint32_t aisle) const;
+
+            /** \brief Endereço do intermediário dos sensores visto pelo ponto de acesso do corredor aisle.
+             */
+            Ipv4Address GetCoreAddress (uint32_t aisle) const;
+
+        private:
+            /** \brief Posiciona os nós; a infraestrutura fica à frente do primeiro corredor.
+             */
+            void Place ();
+
+            /** \brief Atribui um canal a cada corredor, a partir das posições dos pontos de acesso.
+             */
+            void AssignChannels ();
+
+            /** \brief Liga os pontos de acesso à infraestrutura e instala as rotas agregadas.
+             */
+            void BuildBackhaul (const NetDeviceContainer &lanDevices, AddressPlanner &planner);
+
+            uint32_t m_shelves;
+            uint32_t m_shelvesPerAisle;
+            uint32_t m_aisles;
+            uint32_t m_serverCount;
+            Backhaul m_backhaul;
+            std::string m_dataRate;
+            Time m_delay;
+            double m_aisleSpacing;
+            double m_shelfSpacing;
+            double m_shelfHeight;
+            WifiPhyBand m_band;
+            uint16_t m_channelWidth;
+            std::vector<uint8_t> m_channels; /**< Canais disponíveis, em ordem de preferência */
+            double m_interferenceRange;
+            std::vector<uint8_t> m_cellChannels; /**< Canal atribuído a cada corredor */
+            std::vector<NetDeviceContainer> m_cellDevices;
+            NodeContainer m_sensors; /**< Sensores em ordem de prateleira, corredor após corredor */
+            NodeContainer m_accessPoints; /**< Um por corredor */
+            NodeContainer m_servers;
+            NodeContainer m_relays;
+            NodeContainer m_gateway;
+            Ipv4InterfaceContainer m_sensorInterfaces;
+            Ipv4InterfaceContainer m_cellInterfaces; /**< Ponto de acesso de cada corredor na sua célula */
+            Ipv4InterfaceContainer m_uplinkInterfaces; /**< Ponto de acesso de cada corredor no backhaul */
+            Ipv4InterfaceContainer m_coreInterfaces; /**< Intermediário dos sensores no enlace de cada corredor */
+            Ipv4InterfaceContainer m_serverInterfaces;
+            Ipv4InterfaceContainer m_relayInterfaces;
+            Ipv4InterfaceContainer m_gatewayInterfaces;
+    };
+}
+
+#endif
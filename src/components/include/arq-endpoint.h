@@ -0,0 +1,133 @@
+#ifndef ARQ_ENDPOINT_H
+#define ARQ_ENDPOINT_H
+#include "ns3/simple-ref-count.h"
+#include "ns3/socket.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "warehouse-protocol.h"
+#include "latency-tag.h"
+#include <deque>
+#include <map>
+#include <vector>
+
+namespace ns3
+{
+    /** \brief Contadores da entrega confiável, somados de todos os ArqEndpoint da simulação.
+     */
+    typedef struct
+    {
+        uint64_t reliableFrames; /**< Quadros enviados com FRAME_FLAG_RELIABLE, sem contar retransmissões */
+        uint64_t retransmissions; /**< Reenvios por estouro do RTO */
+        uint64_t acksSent; /**< Quadros de confirmação enviados */
+        uint64_t failed; /**< Quadros abandonados após MAX_RETRIES reenvios ou por janela cheia */
+        uint64_t duplicates; /**< Quadros recebidos de novo e descartados */
+        uint64_t outOfWindow; /**< Quadros recebidos além da janela de recepção e descartados */
+        uint64_t deliveredFrames; /**< Quadros de dados entregues à aplicação, uma vez cada */
+        uint64_t deliveredBytes; /**< Bytes desses quadros */
+    } ArqStats;
+
+    /** \brief Entrega confiável (ARQ) entre um nó e cada um dos seus vizinhos, sobre o socket UDP do nó.
+     *
+     * Do lado do envio, o FrameWriter numera os quadros unicast por vizinho com NextSequence(), marca-os com
+     * FRAME_FLAG_RELIABLE e os entrega a OnSent(), que guarda uma cópia até a confirmação. A confirmação é
+     * cumulativa: um quadro FRAME_FLAG_ACK sem registros cujo sequence é o próximo número esperado pelo
+     * receptor. Se nada for confirmado em um RTO, o quadro mais antigo pendente é reenviado e o RTO dobra.
+     * O RTO segue Jacobson/Karels (RFC 6298), medido apenas em quadros não reenviados (algoritmo de Karn).
+     * Um quadro abandonado após MAX_RETRIES reenvios travaria a confirmação cumulativa; por isso o remetente
+     * envia um aviso FRAME_FLAG_FORWARD com o primeiro número ainda válido, repetido a cada RTO até ser
+     * confirmado, como o FORWARD-TSN do SCTP com confiabilidade parcial.
+     *
+     * Do lado da recepção, Receive() deve ser chamado para cada quadro válido: consome as confirmações,
+     * confirma os quadros confiáveis e descarta os repetidos, usando uma janela de MAX_UNACKED números de
+     * sequência por vizinho; quadros fora de ordem dentro da janela são entregues imediatamente.
+     * Um endpoint desativado envia sem confirmação, mas ainda confirma o que recebe com FRAME_FLAG_RELIABLE.
+     */
+    class ArqEndpoint : public SimpleRefCount<ArqEndpoint>
+    {
+        public:
+            /** Quadros sem confirmação por vizinho; também é o tamanho da janela de recepção */
+            static const uint32_t MAX_UNACKED = 64;
+            /** Reenvios de um quadro antes de abandoná-lo */
+            static const uint32_t MAX_RETRIES = 6;
+
+            ArqEndpoint(Ptr<Socket> socket, uint16_t port, bool enabled);
+            ~ArqEndpoint();
+
+            /** \brief Se os quadros unicast enviados por este nó esperam confirmação.
+             */
+            bool IsEnabled () const;
+
+            /** \brief Próximo número de sequência para peer.
+             */
+            uint16_t NextSequence (Ipv4Address peer);
+
+            /** \brief Guarda uma cópia do quadro confiável de número sequence enviado para peer, com o tag
+             * que os reenvios devem levar, e arma o temporizador de reenvio.
+             */
+            void OnSent (Ipv4Address peer, uint16_t sequence, const uint8_t *bytes, uint32_t size, const LatencyTag &tag);
+
+            /** \brief Processa o cabeçalho de um quadro de size bytes recebido de from. Retorna true se os
+             * registros do quadro devem ser processados pela aplicação, e false para confirmações e repetidos.
+             */
+            bool Receive (Ipv4Address from, const FrameHeader &header, uint32_t size);
+
+            /** \brief Cancela os temporizadores; quadros ainda pendentes não são mais reenviados.
+             */
+            void Close ();
+
+            /** \brief RTO atual para peer, ou o RTO inicial se ainda não houve medição.
+             */
+            Time GetRto (Ipv4Address peer) const;
+
+            /** \brief Bytes ocupados pelo estado dos vizinhos e pelas cópias pendentes.
+             */
+            uint32_t GetMemoryUsage () const;
+
+            static const ArqStats &GetStats ();
+
+        private:
+            /** \brief Quadro enviado e ainda não confirmado */
+            typedef struct
+            {
+                uint16_t sequence;
+                uint8_t retries;
+                Time sentAt; /**< Instante do primeiro envio */
+                LatencyTag tag;
+                std::vector<uint8_t> bytes;
+            } Unacked;
+
+            /** \brief Estado da comunicação com um vizinho, nos dois sentidos */
+            typedef struct
+            {
+                uint16_t nextSequence; /**< Próximo número a enviar */
+                std::deque<Unacked> unacked; /**< Quadros pendentes, em ordem de sequência */
+                double srtt; /**< RTT suavizado, em segundos; negativo antes da primeira medição */
+                double rttvar;
+                Time rto;
+                EventId timer;
+                bool forwardPending; /**< Há um aviso FRAME_FLAG_FORWARD ainda não confirmado */
+                uint16_t forward; /**< Primeiro número não abandonado, levado pelo aviso */
+                uint16_t expected; /**< Próximo número esperado deste vizinho */
+                uint64_t received; /**< Bit i: quadro expected + i já recebido */
+            } Peer;
+
+            Peer &GetPeer (Ipv4Address address);
+            void HandleAck (Ipv4Address from, uint16_t ack);
+            void HandleForward (Ipv4Address from, uint16_t forward);
+            /** \brief Desiste do quadro pendente mais antigo para peer e avisa o receptor. */
+            void Abandon (Ipv4Address peer, Peer &p);
+            void SendControl (Ipv4Address to, uint8_t flags, uint16_t sequence);
+            void Timeout (Ipv4Address peer);
+            void Transmit (Ipv4Address to, const Unacked &frame);
+
+            Ptr<Socket> m_socket;
+            uint16_t m_port;
+            bool m_enabled;
+            std::map<Ipv4Address, Peer> m_peers;
+
+            static ArqStats s_stats;
+    };
+}
+
+#endif
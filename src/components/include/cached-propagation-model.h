@@ -0,0 +1,100 @@
+#ifndef CACHED_PROPAGATION_MODEL_H
+#define CACHED_PROPAGATION_MODEL_H
+#include "ns3/propagation-loss-model.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/mobility-model.h"
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+    /** \brief Contadores dos caches de propagação, somados de todos os modelos da simulação.
+     */
+    typedef struct
+    {
+        uint64_t hits; /**< Perdas ou atrasos servidos do cache */
+        uint64_t misses; /**< Perdas ou atrasos calculados pelo modelo envolvido, na primeira vez ou após um movimento */
+        uint64_t invalidations; /**< Mudanças de posição que descartaram valores do cache */
+    } PropagationCacheStats;
+
+    /** \brief Valores por par (transmissor, receptor) de modelos de mobilidade, válidos enquanto nenhum dos dois se move.
+     *
+     * Cada modelo de mobilidade recebe um índice na primeira consulta e uma geração, incrementada pelo trace
+     * CourseChange; uma entrada guarda as gerações do par e deixa de valer quando uma delas muda, sem que o
+     * movimento precise procurar as entradas do nó.
+     */
+    class MobilityPairCache
+    {
+        public:
+            MobilityPairCache();
+
+            /** \brief Copia para value o valor guardado para (a, b), se ainda válido.
+             */
+            bool Lookup (Ptr<MobilityModel> a, Ptr<MobilityModel> b, double &value);
+
+            void Store (Ptr<MobilityModel> a, Ptr<MobilityModel> b, double value);
+
+            static const PropagationCacheStats &GetStats();
+
+        private:
+            typedef struct
+            {
+                double value;
+                uint32_t generationA;
+                uint32_t generationB;
+            } Entry;
+
+            uint32_t GetIndex (Ptr<MobilityModel> model);
+            uint64_t GetKey (uint32_t a, uint32_t b) const;
+            void NotifyCourseChange (Ptr<const MobilityModel> model);
+
+            std::unordered_map<const MobilityModel *, uint32_t> m_index;
+            std::vector<uint32_t> m_generation; /**< Geração de cada modelo de mobilidade, pelo índice */
+            std::unordered_map<uint64_t, Entry> m_entries;
+
+            static PropagationCacheStats s_stats;
+    };
+
+    /** \brief Memoriza a perda de um modelo determinístico (LogDistance por padrão) para cada par de nós parados.
+     *
+     * O canal Yans calcula a perda para cada receptor em cada transmissão; com os nós do armazém em posições
+     * fixas o resultado é sempre o mesmo, e o cache o reaproveita até que um dos nós se mova. A perda em dB não
+     * depende da potência de transmissão, então um mesmo valor serve a qualquer potência. Modelos aleatórios
+     * (Nakagami, por exemplo) não devem ser envolvidos, pois o cache congelaria o primeiro sorteio de cada par.
+     */
+    class CachedPropagationLossModel : public PropagationLossModel
+    {
+        public:
+            static TypeId GetTypeId (void);
+
+            CachedPropagationLossModel();
+
+        private:
+            virtual double DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+            virtual int64_t DoAssignStreams (int64_t stream);
+
+            Ptr<PropagationLossModel> m_model; /**< Modelo envolvido, com a sua própria cadeia */
+            mutable MobilityPairCache m_cache; /**< Perda em dB de cada par */
+    };
+
+    /** \brief Memoriza o atraso de um modelo determinístico (velocidade constante por padrão) para cada par de nós
+     * parados, como CachedPropagationLossModel.
+     */
+    class CachedPropagationDelayModel : public PropagationDelayModel
+    {
+        public:
+            static TypeId GetTypeId (void);
+
+            CachedPropagationDelayModel();
+
+            virtual Time GetDelay (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+
+        private:
+            virtual int64_t DoAssignStreams (int64_t stream);
+
+            Ptr<PropagationDelayModel> m_model;
+            mutable MobilityPairCache m_cache; /**< Atraso de cada par, em unidades de Time */
+    };
+}
+
+#endif
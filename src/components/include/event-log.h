@@ -0,0 +1,107 @@
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+#include "warehouse-protocol.h"
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+    /** \brief Tipos de evento registrados no EventLog.
+     */
+    enum EventType
+    {
+        EVENT_PACKET = 0, /**< Pacote recebido; size é o tamanho do pacote e os campos do registro ficam zerados */
+        EVENT_RECORD = 1, /**< Registro processado por um nó */
+        EVENT_INVALID_FRAME = 2, /**< Quadro descartado por versão desconhecida ou tamanho inconsistente */
+        EVENT_SENT_RECORD = 3 /**< Registro enviado por um nó, como a resposta de um sensor */
+    };
+
+    /** \brief Níveis do EventLog; cada nível inclui os anteriores.
+     */
+    enum EventLogLevel
+    {
+        EVENT_LOG_NONE = 0, /**< Nada é registrado */
+        EVENT_LOG_PACKETS = 1, /**< Pacotes recebidos e quadros descartados */
+        EVENT_LOG_RECORDS = 2 /**< Também cada registro processado */
+    };
+
+    /** \brief Um evento. No formato binário ocupa EventLog::ENTRY_SIZE bytes.
+     */
+    typedef struct
+    {
+        int64_t time; /**< Instante da simulação em nanossegundos */
+        uint32_t node; /**< Id ns-3 do nó que registrou o evento */
+        uint32_t size; /**< Tamanho do pacote, para EVENT_PACKET e EVENT_INVALID_FRAME */
+        uint8_t type; /**< EventType */
+        uint32_t source;
+        uint32_t dest;
+        uint8_t command;
+        uint32_t payload;
+    } EventEntry;
+
+    /** \brief Registro de eventos da simulação em um buffer circular pré-alocado, no lugar de escrever
+     * cada evento no terminal. Com um arquivo configurado, o buffer é gravado quando enche e em Close();
+     * sem arquivo, os eventos mais antigos são sobrescritos e apenas os últimos capacity ficam disponíveis.
+     *
+     * O formato binário é little-endian: os bytes mágicos "WHEV", a versão (u16) e o tamanho de um evento (u16),
+     * seguidos dos eventos, cada um com time (i64), node (u32), size (u32), type (u8), source, dest (u32),
+     * command (u8) e payload (u32).
+     */
+    class EventLog
+    {
+        public:
+            enum Format
+            {
+                CSV,
+                BINARY
+            };
+
+            static const uint16_t VERSION = 2;
+            static const uint32_t ENTRY_SIZE = 30;
+            static const uint32_t DEFAULT_CAPACITY = 65536;
+
+            EventLog();
+            ~EventLog();
+
+            /** \brief Define o nível e o tamanho do buffer e, se path não for vazio, abre o arquivo de saída.
+             * Retorna false se o arquivo não puder ser aberto.
+             */
+            bool Configure(EventLogLevel level, uint32_t capacity, const std::string &path, Format format);
+
+            bool IsEnabled(EventLogLevel level) const;
+
+            void LogPacket(uint32_t node, uint32_t size);
+            void LogInvalidFrame(uint32_t node, uint32_t size);
+            void LogRecord(uint32_t node, const ShelfRecord &record);
+            void LogSentRecord(uint32_t node, const ShelfRecord &record);
+
+            /** \brief Grava os eventos ainda no buffer e fecha o arquivo.
+             */
+            void Close();
+
+            /** \brief Eventos registrados desde Configure, incluindo os já gravados ou sobrescritos.
+             */
+            uint64_t GetLogged() const;
+
+            /** \brief Eventos sobrescritos por falta de espaço, quando não há arquivo configurado.
+             */
+            uint64_t GetOverwritten() const;
+
+        private:
+            void Append(uint8_t type, uint32_t node, uint32_t size, const ShelfRecord *record);
+            void Write(const EventEntry &entry);
+            void Drain();
+
+            EventLogLevel m_level;
+            std::vector<EventEntry> m_entries; /**< Buffer circular, alocado em Configure */
+            uint32_t m_head; /**< Posição do evento mais antigo */
+            uint32_t m_count; /**< Eventos no buffer */
+            std::ofstream m_out;
+            Format m_format;
+            uint64_t m_logged;
+            uint64_t m_overwritten;
+    };
+}
+
+#endif
@@ -0,0 +1,146 @@
+#ifndef FRAME_WRITER_H
+#define FRAME_WRITER_H
+#include "ns3/socket.h"
+#include "ns3/packet.h"
+#include "ns3/ipv4-address.h"
+#include "warehouse-protocol.h"
+#include "latency-tag.h"
+#include "arq-endpoint.h"
+#include "metrics-registry.h"
+#include <memory>
+#include <vector>
+
+namespace ns3
+{
+    /** \brief Alocações de memória da camada de codificação (buffers do FrameWriter), somadas de toda a simulação.
+     * Os pacotes entregues ao socket, um por datagrama, pertencem à pilha do ns-3 e não entram nesta conta.
+     */
+    typedef struct
+    {
+        uint64_t allocations; /**< Chamadas ao alocador */
+        uint64_t bytes; /**< Bytes alocados */
+    } CodecAllocationStats;
+
+    void CountCodecAllocation (uint64_t bytes);
+    const CodecAllocationStats &GetCodecAllocationStats ();
+
+    /** \brief Alocador dos contêineres do FrameWriter que conta cada alocação em CodecAllocationStats, para
+     * medir, e não apenas afirmar, que a codificação não aloca memória depois da construção.
+     */
+    template <typename T>
+    class CountingAllocator
+    {
+        public:
+            typedef T value_type;
+
+            CountingAllocator() {}
+            template <typename U>
+            CountingAllocator(const CountingAllocator<U> &) {}
+
+            T *allocate(std::size_t n)
+            {
+                CountCodecAllocation(n * sizeof(T));
+                return std::allocator<T>().allocate(n);
+            }
+
+            void deallocate(T *p, std::size_t n)
+            {
+                std::allocator<T>().deallocate(p, n);
+            }
+
+            template <typename U>
+            bool operator==(const CountingAllocator<U> &) const { return true; }
+            template <typename U>
+            bool operator!=(const CountingAllocator<U> &) const { return false; }
+    };
+
+    /** \brief Agrupa os registros gerados por um nó por próximo salto e envia um único quadro
+     * para cada próximo salto quando Flush() é chamado. Os registros são codificados diretamente
+     * em buffers fixos, reservados na construção; cada envio cria apenas o pacote do quadro. Os buffers usam
+     * CountingAllocator, então GetCodecAllocationStats() mostra as alocações feitas durante a simulação.
+     */
+    class FrameWriter
+    {
+        public:
+            /** Quantidade padrão de próximos saltos com quadros pendentes ao mesmo tempo */
+            static const uint32_t DEFAULT_PENDING_HOPS = 8;
+
+            FrameWriter();
+            /** \brief Os buffers dos maxPendingHops quadros pendentes são alocados aqui, uma única vez.
+             */
+            FrameWriter(Ptr<Socket> socket, uint16_t port, uint32_t maxPendingHops = DEFAULT_PENDING_HOPS);
+
+            /** \brief Enfileira um registro para nextHop. Se o quadro pendente atingir
+             * MAX_RECORDS_PER_FRAME ele é enviado imediatamente; se todos os maxPendingHops
+             * quadros pendentes estiverem ocupados por outros saltos, eles são enviados antes.
+             */
+            void Append(Ipv4Address nextHop, const ShelfRecord &record);
+
+            /** \brief Como Append(nextHop, record), para um registro gerado a partir de um quadro recebido
+             * com o tag origin. O quadro enviado carrega a origem mais antiga entre seus registros e um
+             * salto a mais que o maior número de saltos entre eles.
+             */
+            void Append(Ipv4Address nextHop, const ShelfRecord &record, const LatencyTag &origin);
+
+            /** \brief Envia todos os quadros pendentes, um por próximo salto. Um quadro para
+             * Ipv4Address::GetBroadcast() ou para um endereço de AddBroadcastAddress leva FRAME_FLAG_BROADCAST e exige
+             * um socket com SetAllowBroadcast(true).
+             */
+            void Flush();
+
+            /** \brief Envia os quadros unicast pela entrega confiável de arq, se ela estiver ativada.
+             */
+            void SetArq (Ptr<ArqEndpoint> arq);
+
+            /** \brief Trata address, o broadcast de uma sub-rede, como difusão: sem confirmação e com FRAME_FLAG_BROADCAST.
+             */
+            void AddBroadcastAddress (Ipv4Address address);
+
+            /** \brief Conta os quadros e bytes enviados nas métricas ids do nó, em metrics.
+             */
+            void SetMetrics (MetricsRegistry *metrics, const NodeMetrics &ids);
+
+            /** \brief Contadores de tráfego somados de todos os FrameWriter da simulação.
+             */
+            static const WireStats &GetStats();
+
+            /** \brief Bytes reservados para os quadros pendentes.
+             */
+            uint32_t GetMemoryUsage() const;
+
+        private:
+            /** \brief Quadro em construção, já no formato de transmissão */
+            typedef struct
+            {
+                Ipv4Address nextHop;
+                uint16_t recordCount;
+                uint32_t size; /**< Bytes já ocupados, incluindo o cabeçalho */
+                Time origin; /**< Origem mais antiga entre os registros do quadro */
+                uint8_t hops; /**< Maior número de saltos entre os registros do quadro */
+                uint8_t bytes[MAX_FRAME_SIZE];
+            } PendingFrame;
+
+            void Send(PendingFrame &frame);
+            bool IsBroadcast(Ipv4Address address) const;
+
+            Ptr<Socket> m_socket; /**< Socket usado para enviar os quadros */
+            uint16_t m_port; /**< Porta de destino dos quadros */
+            uint16_t m_sequence; /**< Número de sequência do próximo quadro */
+            std::vector<PendingFrame, CountingAllocator<PendingFrame>> m_pending; /**< Quadros pendentes por próximo salto, com tamanho fixo */
+            uint32_t m_nPending;
+            Ptr<ArqEndpoint> m_arq; /**< Numera e guarda os quadros confiáveis; nulo envia sem confirmação */
+            std::vector<Ipv4Address, CountingAllocator<Ipv4Address>> m_broadcasts; /**< Broadcasts de sub-rede, além de Ipv4Address::GetBroadcast() */
+            MetricsRegistry *m_metrics; /**< Nulo se as métricas estão desativadas */
+            uint32_t m_packetsSent;
+            uint32_t m_bytesSent;
+
+            static WireStats s_stats;
+    };
+
+    /** \brief Copia o conteúdo do pacote para um buffer na pilha e decodifica o quadro em frame.
+     * Retorna false se o pacote não for um quadro válido.
+     */
+    bool ReadFrame(Ptr<Packet> packet, WarehouseFrame &frame);
+}
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef GATEWAY_CLIENT_APPLICATION_H
+#define GATEWAY_CLIENT_APPLICATION_H
+#include "ns3/application.h"
+#include "ns3/socket.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "frame-writer.h"
+#include "gateway-command-source.h"
+#include "latency-collector.h"
+#include "event-log.h"
+#include <deque>
+
+namespace ns3
+{
+    /** \brief Contadores dos comandos do gateway, somados de todos os gateways da simulação.
+     */
+    typedef struct
+    {
+        uint64_t issued; /**< Comandos enviados ao servidor */
+        uint64_t completed; /**< Comandos com resposta (sucesso ou erro) dentro do prazo */
+        uint64_t timedOut; /**< Comandos sem resposta em CommandTimeout, que liberaram a vaga na janela */
+        uint64_t late; /**< Respostas que chegaram depois do prazo do comando */
+        Time firstIssue; /**< Envio do primeiro comando */
+        Time lastCompletion; /**< Chegada da última resposta no prazo */
+    } GatewayClientStats;
+
+    /** \brief Gateway: envia ao servidor os comandos de esvaziar e preencher de uma GatewayCommandSource e recebe as respostas.
+     *
+     * Com Window igual a zero, os comandos saem em ritmo fixo, um a cada Interval. Com Window = W, até W comandos
+     * ficam pendentes ao mesmo tempo e o próximo sai assim que chega uma resposta, de sucesso ou de erro, de modo
+     * que a vazão de comandos é limitada apenas pela rede e pelo servidor. As respostas não identificam o comando,
+     * então cada resposta conclui o comando pendente mais antigo; um comando sem resposta em CommandTimeout
+     * é dado como perdido e libera sua vaga. Erros de inconsistência (código 5) não respondem a comandos e não contam.
+     */
+    class GatewayClientApplication : public Application
+    {
+        public:
+            static TypeId GetTypeId (void);
+            virtual TypeId GetInstanceTypeId (void) const;
+
+            GatewayClientApplication();
+            virtual ~GatewayClientApplication();
+
+            /** \brief Define de onde vêm os comandos, consumidos na ordem.
+             */
+            void SetCommandSource (Ptr<GatewayCommandSource> source);
+
+            /** \brief Registra os pacotes e registros recebidos em log, que deve existir enquanto a aplicação rodar.
+             */
+            void SetEventLog (EventLog *log);
+
+            /** \brief Acumula a latência de cada resposta em latency, que deve existir enquanto a aplicação rodar.
+             */
+            void SetLatencyCollector (LatencyCollector *latency);
+
+            /** \brief Conta os pacotes, registros e comandos pendentes em metrics, que deve existir enquanto a aplicação rodar.
+             */
+            void SetMetrics (MetricsRegistry *metrics);
+
+            /** \brief Processa os quadros recebidos do intermediário.
+             */
+            void HandleRead (Ptr<Socket> socket);
+
+            static const GatewayClientStats &GetStats ();
+
+        protected:
+            virtual void DoDispose ();
+
+            /** \brief Começa a enviar os comandos, logo depois que o socket é aberto. Por padrão, em ritmo fixo
+             * ou enchendo a janela, conforme Window.
+             */
+            virtual void StartSending ();
+
+            /** \brief Envia o próximo comando da fonte. Retorna false se não há mais comandos a enviar.
+             */
+            bool IssueNext ();
+
+            Ptr<GatewayCommandSource> m_source;
+            EventId m_sendEvent; /**< Próximo envio agendado, cancelado ao parar a aplicação */
+
+        private:
+            virtual void StartApplication ();
+            virtual void StopApplication ();
+
+            /** \brief Envio em ritmo fixo, com Window igual a zero.
+             */
+            void PacedIssue ();
+
+            /** \brief Completa a janela com novos comandos.
+             */
+            void FillWindow ();
+
+            /** \brief Descarta os comandos pendentes cujo prazo terminou.
+             */
+            void ExpireCommands ();
+
+            void ScheduleExpiry ();
+
+            uint16_t m_port;
+            Ipv4Address m_relayAddress; /**< Intermediário entre gateway e servidor */
+            uint32_t m_window; /**< Comandos pendentes ao mesmo tempo; zero envia em ritmo fixo */
+            Time m_interval; /**< Intervalo entre comandos com Window igual a zero */
+            uint32_t m_maxCommands; /**< Comandos a enviar; zero envia todos os da fonte */
+            Time m_commandTimeout;
+            bool m_reliable;
+            std::deque<Time> m_outstanding; /**< Instante de envio de cada comando pendente, do mais antigo ao mais novo */
+            uint64_t m_issued; /**< Comandos enviados por esta aplicação */
+            EventId m_expiryEvent;
+            EventLog *m_log;
+            LatencyCollector *m_latency;
+            MetricsRegistry *m_metrics;
+            NodeMetrics m_metricIds;
+            uint32_t m_outstandingGauge; /**< Comandos pendentes */
+            Ptr<Socket> m_socket;
+            FrameWriter m_writer;
+            Ptr<ArqEndpoint> m_arq;
+
+            static GatewayClientStats s_stats;
+    };
+}
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef GATEWAY_COMMAND_SOURCE_H
+#define GATEWAY_COMMAND_SOURCE_H
+#include "ns3/simple-ref-count.h"
+#include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
+#include "instance-loader.h"
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+    /** \brief Fonte dos comandos do gateway. Cada chamada a Next() consome o próximo comando
+     * (COMMAND_EMPTY ou COMMAND_FILL) e a prateleira alvo, no mesmo formato de um registro do gateway.
+     */
+    class GatewayCommandSource : public SimpleRefCount<GatewayCommandSource>
+    {
+        public:
+            virtual ~GatewayCommandSource();
+
+            /** \brief Indica se ainda há comandos.
+             */
+            virtual bool HasNext() const = 0;
+
+            /** \brief Consome o próximo comando. Só deve ser chamada se HasNext() for true.
+             */
+            virtual void Next(uint8_t &command, uint32_t &target) = 0;
+    };
+
+    /** \brief Comandos lidos das linhas de comandos e alvos do gateway na instância.
+     */
+    class InstanceCommandSource : public GatewayCommandSource
+    {
+        public:
+            InstanceCommandSource(RowCursor commands, RowCursor targets);
+
+            virtual bool HasNext() const;
+            virtual void Next(uint8_t &command, uint32_t &target);
+
+        private:
+            mutable RowCursor m_commands;
+            mutable RowCursor m_targets;
+    };
+
+    /** \brief Comandos sorteados sem fim: preencher com probabilidade fillRatio, senão esvaziar, em uma prateleira
+     * de 1 a shelves escolhida uniformemente ou, com zipfExponent maior que zero, por uma distribuição de Zipf
+     * em que a prateleira k tem peso 1 / k^zipfExponent (as prateleiras de identificador baixo são as mais pedidas).
+     */
+    class RandomCommandSource : public GatewayCommandSource
+    {
+        public:
+            RandomCommandSource(uint32_t shelves, double fillRatio, double zipfExponent);
+
+            virtual bool HasNext() const;
+            virtual void Next(uint8_t &command, uint32_t &target);
+
+        private:
+            uint32_t m_shelves;
+            double m_fillRatio;
+            Ptr<UniformRandomVariable> m_command;
+            Ptr<UniformRandomVariable> m_uniform; /**< Alvo, com zipfExponent igual a zero */
+            Ptr<ZipfRandomVariable> m_zipf; /**< Alvo, com zipfExponent maior que zero */
+    };
+
+    /** \brief Comandos reproduzidos de um arquivo de texto com uma linha "instante comando alvo" por comando,
+     * em ordem crescente de instante (segundos a partir do início do gateway). Linhas vazias e iniciadas
+     * por '#' são ignoradas.
+     */
+    class TraceCommandSource : public GatewayCommandSource
+    {
+        public:
+            TraceCommandSource();
+
+            /** \brief Lê o arquivo inteiro. Retorna false e preenche GetError() se ele não puder ser lido ou
+             * tiver uma linha mal formada ou fora de ordem.
+             */
+            bool Load(const std::string &path);
+            const std::string &GetError() const;
+
+            virtual bool HasNext() const;
+            virtual void Next(uint8_t &command, uint32_t &target);
+
+            /** \brief Instante do próximo comando. Só deve ser chamada se HasNext() for true.
+             */
+            Time PeekTime() const;
+
+        private:
+            typedef struct
+            {
+                Time time;
+                uint8_t command;
+                uint32_t target;
+            } Entry;
+
+            std::vector<Entry> m_entries;
+            uint32_t m_next;
+            std::string m_error;
+    };
+}
+
+#endif
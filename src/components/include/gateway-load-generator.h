@@ -0,0 +1,67 @@
+#ifndef GATEWAY_LOAD_GENERATOR_H
+#define GATEWAY_LOAD_GENERATOR_H
+#include "ns3/random-variable-stream.h"
+#include "gateway-client-application.h"
+
+namespace ns3
+{
+    /** \brief Gateway em malha aberta: os comandos saem conforme um processo de chegadas, sem esperar pelas
+     * respostas, para medir a latência do servidor em função da carga oferecida.
+     *
+     *   - Poisson: intervalos exponenciais de média 1 / Rate;
+     *   - OnOff: rajadas de Poisson à taxa Rate durante períodos ativos de duração exponencial de média OnTime,
+     *     separadas por silêncios de duração exponencial de média OffTime;
+     *   - Trace: os instantes e os comandos de uma TraceCommandSource, definida com SetTrace().
+     *
+     * Fora do modo Trace, sem uma fonte definida com SetCommandSource(), os comandos são sorteados por uma
+     * RandomCommandSource com Shelves, FillRatio e ZipfExponent. As respostas são tratadas como no
+     * GatewayClientApplication, inclusive o prazo CommandTimeout.
+     */
+    class GatewayLoadGenerator : public GatewayClientApplication
+    {
+        public:
+            enum Arrival
+            {
+                POISSON,
+                ON_OFF,
+                TRACE
+            };
+
+            static TypeId GetTypeId (void);
+            virtual TypeId GetInstanceTypeId (void) const;
+
+            GatewayLoadGenerator();
+            virtual ~GatewayLoadGenerator();
+
+            /** \brief Comandos e instantes de envio do modo Trace, relativos ao início da aplicação.
+             */
+            void SetTrace (Ptr<TraceCommandSource> trace);
+
+        protected:
+            virtual void DoDispose ();
+            virtual void StartSending ();
+
+        private:
+            /** \brief Envia um comando e agenda o próximo.
+             */
+            void Arrive ();
+
+            void ScheduleNext ();
+
+            Arrival m_arrival;
+            double m_rate; /**< Comandos por segundo, durante os períodos ativos no modo OnOff */
+            Time m_onTime;
+            Time m_offTime;
+            uint32_t m_shelves;
+            double m_fillRatio;
+            double m_zipfExponent;
+            Time m_start; /**< Início da aplicação, referência dos instantes do trace */
+            Time m_onUntil; /**< Fim do período ativo atual no modo OnOff */
+            Ptr<TraceCommandSource> m_trace;
+            Ptr<ExponentialRandomVariable> m_gap;
+            Ptr<ExponentialRandomVariable> m_on;
+            Ptr<ExponentialRandomVariable> m_off;
+    };
+}
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef INSTANCE_LOADER_H
+#define INSTANCE_LOADER_H
+#include "ns3/simple-ref-count.h"
+#include "ns3/ptr.h"
+#include "shelf-reading-source.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+    /** \brief Cursor sobre uma linha (formato texto) ou coluna (formato binário) da instância, lida sob demanda.
+     * Não é dono da memória; os ponteiros apontam para o arquivo mapeado por InstanceFile.
+     */
+    class RowCursor
+    {
+        public:
+            enum Encoding
+            {
+                TEXT, /**< Inteiros decimais separados por espaços */
+                BITS, /**< Um bit por valor, do bit menos significativo para o mais significativo de cada byte */
+                UINT8, /**< Um byte por valor */
+                UINT32 /**< Quatro bytes little-endian por valor */
+            };
+
+            RowCursor();
+            /** \brief Cursor sobre uma linha de texto entre begin e end.
+             */
+            RowCursor(const char *begin, const char *end);
+            /** \brief Cursor sobre count valores binários a partir de data.
+             */
+            RowCursor(Encoding encoding, const char *data, uint32_t count);
+
+            /** \brief Indica se ainda há valores na linha.
+             */
+            bool HasNext();
+
+            /** \brief Retorna o próximo valor sem consumi-lo. Só deve ser chamada se HasNext() for true.
+             */
+            int32_t Peek();
+
+            /** \brief Consome e retorna o próximo valor. Só deve ser chamada se HasNext() for true.
+             */
+            int32_t Next();
+
+        private:
+            void SkipSpaces();
+            int32_t Parse(const char **cursor) const;
+            int32_t ReadBinary() const;
+
+            Encoding m_encoding;
+            const char *m_cursor;
+            const char *m_end;
+            uint32_t m_index; /**< Próximo valor a ler nas codificações binárias */
+            uint32_t m_count; /**< Quantidade de valores nas codificações binárias */
+    };
+
+    /** \brief Arquivo de instância mapeado em memória com mmap, em formato texto ou binário.
+     *
+     * No formato texto cada linha não vazia é uma linha da instância: as primeiras são as leituras de
+     * cada prateleira, uma prateleira por linha, e as duas últimas são os comandos do gateway e as
+     * prateleiras alvo desses comandos. Qualquer quantidade de prateleiras e de leituras por linha é
+     * aceita. Ao abrir o arquivo apenas as posições das linhas são indexadas.
+     *
+     * O formato binário é colunar, com inteiros little-endian, e é reconhecido pelos bytes mágicos
+     * "WHTR" no início do arquivo:
+     *   - cabeçalho de 24 bytes: "WHTR", versão (u16), reservado (u16), prateleiras S (u32),
+     *     leituras por prateleira T (u32, o máximo entre as prateleiras), comandos do gateway G (u32), reservado (u32);
+     *   - S contadores u32 com a quantidade de leituras de cada prateleira;
+     *   - alinhado a 8 bytes, S blocos de ceil(T / 8) bytes (arredondados para múltiplo de 8) com as leituras
+     *     de cada prateleira, um bit por leitura a partir do bit menos significativo;
+     *   - G bytes com os comandos do gateway e, alinhados a 4 bytes, G alvos u32.
+     *
+     * Em ambos os formatos os valores só são lidos quando consumidos pelos cursores.
+     */
+    class InstanceFile : public SimpleRefCount<InstanceFile>
+    {
+        public:
+            InstanceFile();
+            ~InstanceFile();
+
+            /** \brief Mapeia e indexa o arquivo. Retorna false, com a causa em GetError(), se o arquivo
+             * não puder ser aberto ou não for uma instância válida.
+             */
+            bool Open(const std::string &path);
+
+            const std::string &GetError() const;
+
+            bool IsBinary() const;
+
+            uint32_t GetShelfCount() const;
+
+            /** \brief Cursor sobre as leituras da prateleira de índice shelf (a partir de 0).
+             */
+            RowCursor GetShelfRow(uint32_t shelf) const;
+            RowCursor GetGatewayCommands() const;
+            RowCursor GetGatewayTargets() const;
+
+            /** \brief Grava a instância aberta no formato binário em path. Retorna false, com a causa
+             * em GetError(), se o arquivo não puder ser escrito.
+             */
+            bool WriteBinary(const std::string &path);
+
+        private:
+            void Close();
+            bool IndexText();
+            bool IndexBinary();
+
+            const char *m_data; /**< Início do arquivo mapeado */
+            size_t m_size;
+            std::string m_error;
+
+            // formato texto
+            std::vector<std::pair<uint64_t, uint64_t>> m_rows; /**< Início e fim de cada linha não vazia */
+
+            // formato binário
+            bool m_binary;
+            uint32_t m_shelfCount;
+            uint32_t m_gatewayCount;
+            uint32_t m_bytesPerShelf; /**< Bytes reservados para as leituras de cada prateleira */
+            uint64_t m_countsOffset; /**< Coluna com a quantidade de leituras de cada prateleira */
+            uint64_t m_readingsOffset;
+            uint64_t m_commandsOffset;
+            uint64_t m_targetsOffset;
+    };
+
+    /** \brief Fonte de leituras de um sensor lidas sob demanda de um InstanceFile.
+     */
+    class MappedReadingSource : public ShelfReadingSource
+    {
+        public:
+            MappedReadingSource(Ptr<InstanceFile> file, uint32_t shelf);
+
+            virtual bool HasNext() const;
+            virtual bool Next();
+
+        private:
+            Ptr<InstanceFile> m_file; /**< Mantém o arquivo mapeado enquanto a fonte existir */
+            mutable RowCursor m_row;
+    };
+}
+
+#endif
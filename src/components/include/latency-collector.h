@@ -0,0 +1,41 @@
+#ifndef LATENCY_COLLECTOR_H
+#define LATENCY_COLLECTOR_H
+#include "ns3/nstime.h"
+#include <map>
+#include <ostream>
+#include <vector>
+
+namespace ns3
+{
+    /** \brief Acumula as latências de ponta a ponta medidas com LatencyTag, separadas pelo
+     * código do comando, e resume cada comando em percentis e em um histograma ao fim da simulação.
+     */
+    class LatencyCollector
+    {
+        public:
+            void Record (uint8_t command, Time latency, uint8_t hops);
+
+            uint32_t GetCount (uint8_t command) const;
+
+            /** \brief Percentil p (0 a 100) das latências do comando, em milissegundos, pelo método
+             * do posto mais próximo. Retorna 0 se não houver amostras.
+             */
+            double GetPercentile (uint8_t command, double p) const;
+
+            /** \brief Escreve, para cada comando, a quantidade de amostras, média, p50, p95, p99, máximo,
+             * média de saltos e o histograma das latências em faixas que dobram a partir de 0,1 ms.
+             */
+            void Print (std::ostream &os) const;
+
+        private:
+            typedef struct
+            {
+                std::vector<double> latencies; /**< Latências em milissegundos, na ordem em que chegaram */
+                uint64_t hops; /**< Soma dos saltos */
+            } Samples;
+
+            std::map<uint8_t, Samples> m_samples; /**< Amostras por código de comando */
+    };
+}
+
+#endif
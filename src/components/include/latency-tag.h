@@ -0,0 +1,45 @@
+#ifndef LATENCY_TAG_H
+#define LATENCY_TAG_H
+#include "ns3/tag.h"
+#include "ns3/nstime.h"
+
+namespace ns3
+{
+    /** \brief Tag com o instante em que o comando que originou os registros de um quadro foi emitido
+     * e a quantidade de saltos percorridos desde então. Cada nó copia o tag do quadro recebido para
+     * os quadros que gera a partir dele, e o FrameWriter incrementa a contagem de saltos a cada envio.
+     *
+     * Como um quadro pode agregar registros de comandos diferentes, o tag carrega a origem mais antiga
+     * entre eles; nesse caso a latência medida é um limite superior.
+     */
+    class LatencyTag : public Tag
+    {
+        public:
+            static TypeId GetTypeId (void);
+            virtual TypeId GetInstanceTypeId (void) const;
+            virtual uint32_t GetSerializedSize (void) const;
+            virtual void Serialize (TagBuffer i) const;
+            virtual void Deserialize (TagBuffer i);
+            virtual void Print (std::ostream &os) const;
+
+            /** \brief Origem no instante atual, sem saltos.
+             */
+            LatencyTag();
+            LatencyTag(Time origin, uint8_t hops);
+
+            Time GetOrigin () const;
+            uint8_t GetHops () const;
+            void SetOrigin (Time origin);
+            void SetHops (uint8_t hops);
+
+            /** \brief Tempo decorrido desde a origem.
+             */
+            Time GetElapsed () const;
+
+        private:
+            Time m_origin; /**< Instante em que o comando foi emitido */
+            uint8_t m_hops; /**< Saltos percorridos desde a origem */
+    };
+}
+
+#endif
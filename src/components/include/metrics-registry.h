@@ -0,0 +1,153 @@
+#ifndef METRICS_REGISTRY_H
+#define METRICS_REGISTRY_H
+#include "warehouse-protocol.h"
+#include <fstream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+    /** \brief Quantidade de códigos de erro do protocolo (payload de COMMAND_ERROR), de ERROR_INVALID_SOURCE a ERROR_INCONSISTENT.
+     */
+    static const uint32_t ERROR_CODES = ERROR_INCONSISTENT + 1;
+
+    /** \brief Identificadores das métricas comuns a todos os papéis, criados por MetricsRegistry::AddNode.
+     */
+    typedef struct
+    {
+        uint32_t packetsReceived;
+        uint32_t bytesReceived;
+        uint32_t packetsSent;
+        uint32_t bytesSent;
+        uint32_t invalidFrames; /**< Quadros descartados por versão desconhecida ou tamanho inconsistente */
+        uint32_t records; /**< Registros processados */
+        uint32_t errorsSent[ERROR_CODES]; /**< Registros COMMAND_ERROR gerados pelo nó, por código */
+        uint32_t errorsReceived[ERROR_CODES]; /**< Registros COMMAND_ERROR recebidos pelo nó, por código */
+        uint32_t discrepancies; /**< Relatos de sensores divergentes da tabela do servidor */
+        uint32_t logExhausted; /**< Fim das leituras de um sensor ou dos comandos do gateway */
+        uint32_t frameBytes; /**< Histograma do tamanho dos quadros recebidos */
+    } NodeMetrics;
+
+    /** \brief Registro de métricas da simulação: contadores, medidores (último valor) e histogramas, agrupados
+     * por nó e gravados em JSON ao fim da simulação.
+     *
+     * As métricas são criadas na configuração e identificadas por índice; Increment, Set e Observe apenas
+     * atualizam uma posição de um vetor, para que os papéis possam usá-los a cada pacote. Os histogramas têm
+     * faixas que dobram a partir de firstBound, e a última faixa não tem limite superior.
+     */
+    class MetricsRegistry
+    {
+        public:
+            enum Type
+            {
+                COUNTER,
+                GAUGE,
+                HISTOGRAM
+            };
+
+            MetricsRegistry();
+
+            /** \brief Abre o arquivo onde Dump() grava as métricas. Retorna false se não puder ser aberto;
+             * com path vazio, Dump() não grava nada.
+             */
+            bool Configure (const std::string &path);
+
+            bool IsEnabled () const;
+
+            uint32_t AddCounter (uint32_t node, const std::string &name);
+            uint32_t AddGauge (uint32_t node, const std::string &name);
+            uint32_t AddHistogram (uint32_t node, const std::string &name, double firstBound, uint32_t buckets);
+
+            /** \brief Cria as métricas comuns do nó node (id ns-3), que desempenha o papel role.
+             */
+            NodeMetrics AddNode (uint32_t node, const std::string &role);
+
+            void Increment (uint32_t id, uint64_t delta = 1)
+            {
+                m_metrics[id].count += delta;
+            }
+
+            void Set (uint32_t id, double value)
+            {
+                m_metrics[id].value = value;
+            }
+
+            void Observe (uint32_t id, double value)
+            {
+                Metric &metric = m_metrics[id];
+                uint32_t bucket = 0;
+                for (double bound = metric.firstBound; value >= bound && bucket + 1 < metric.buckets; bound *= 2)
+                {
+                    bucket++;
+                }
+                m_buckets[metric.offset + bucket]++;
+                metric.count++;
+                metric.value += value;
+            }
+
+            /** \brief Conta um quadro de size bytes recebido pelo nó de ids.
+             */
+            void OnPacket (const NodeMetrics &ids, uint32_t size)
+            {
+                Increment(ids.packetsReceived);
+                Increment(ids.bytesReceived, size);
+                Observe(ids.frameBytes, size);
+            }
+
+            /** \brief Conta o registro record recebido pelo nó de ids, e o código se for um erro.
+             */
+            void OnRecord (const NodeMetrics &ids, const ShelfRecord &record)
+            {
+                Increment(ids.records);
+                if (record.command == COMMAND_ERROR && record.payload < ERROR_CODES)
+                {
+                    Increment(ids.errorsReceived[record.payload]);
+                }
+            }
+
+            uint64_t GetCount (uint32_t id) const;
+
+            /** \brief Escreve as métricas em JSON: {"time": s, "nodes": [{"node", "role", "counters", "gauges", "histograms"}]}.
+             */
+            void WriteJson (std::ostream &os) const;
+
+            /** \brief Grava as métricas no arquivo de Configure e o fecha. Pensado para Simulator::ScheduleDestroy.
+             */
+            void Dump ();
+
+        private:
+            typedef struct
+            {
+                std::string name;
+                Type type;
+                uint64_t count; /**< Contador, ou amostras do histograma */
+                double value; /**< Medidor, ou soma das amostras do histograma */
+                double firstBound;
+                uint32_t buckets;
+                uint32_t offset; /**< Primeira faixa do histograma em m_buckets */
+            } Metric;
+
+            typedef struct
+            {
+                uint32_t node;
+                std::string role;
+                std::vector<uint32_t> metrics; /**< Métricas do nó, na ordem em que foram criadas */
+            } Node;
+
+            uint32_t Add (uint32_t node, const std::string &name, Type type);
+
+            /** \brief Posição do nó em m_nodes, criando-o sem papel se ainda não existir.
+             */
+            Node &GetNode (uint32_t node);
+
+            std::vector<Metric> m_metrics;
+            std::vector<uint64_t> m_buckets; /**< Faixas de todos os histogramas */
+            std::vector<Node> m_nodes; /**< Nós na ordem em que foram registrados */
+            std::map<uint32_t, uint32_t> m_nodeIndex; /**< Posição em m_nodes por id ns-3, usado só na configuração */
+            std::ofstream m_out;
+    };
+}
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef SHELF_READING_SOURCE_H
+#define SHELF_READING_SOURCE_H
+#include "ns3/simple-ref-count.h"
+
+namespace ns3
+{
+    /** \brief Fonte das leituras de um sensor de prateleira. Cada chamada a Next() consome a
+     * próxima leitura do log do sensor (true = prateleira cheia).
+     */
+    class ShelfReadingSource : public SimpleRefCount<ShelfReadingSource>
+    {
+        public:
+            virtual ~ShelfReadingSource();
+
+            /** \brief Indica se ainda há leituras no log do sensor.
+             */
+            virtual bool HasNext() const = 0;
+
+            /** \brief Consome e retorna a próxima leitura. Só deve ser chamada se HasNext() for true.
+             */
+            virtual bool Next() = 0;
+    };
+}
+
+#endif
@@ -0,0 +1,135 @@
+#ifndef SHELF_SENSOR_APPLICATION_H
+#define SHELF_SENSOR_APPLICATION_H
+#include "ns3/application.h"
+#include "ns3/application-container.h"
+#include "ns3/node-container.h"
+#include "ns3/object-factory.h"
+#include "ns3/socket.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/random-variable-stream.h"
+#include "frame-writer.h"
+#include "shelf-reading-source.h"
+#include "shelf-state-table.h"
+#include "event-log.h"
+#include <vector>
+
+namespace ns3
+{
+    /** \brief Contadores das respostas a verificações, somados de todos os sensores da simulação.
+     */
+    typedef struct
+    {
+        uint64_t sent; /**< Respostas enviadas */
+        uint64_t suppressed; /**< Respostas omitidas por não haver mudança de estado */
+        uint64_t heartbeats; /**< Respostas sem mudança de estado enviadas apenas como sinal de vida */
+    } SensorReportStats;
+
+    /** \brief Sensor de uma prateleira. Responde aos comandos de verificação, esvaziamento e
+     * preenchimento repassados pelo nó intermediário, lendo o estado da prateleira de uma ShelfReadingSource.
+     * As respostas a verificações podem ser atrasadas por um tempo aleatório entre 0 e ReplyJitter, para que
+     * os sensores não respondam todos ao mesmo tempo a uma verificação enviada em difusão.
+     *
+     * Com DeltaReporting, o sensor só responde a uma verificação quando o estado mudou desde a última
+     * resposta, ou quando HeartbeatPolls verificações seguidas ficaram sem resposta, como sinal de vida.
+     * O servidor interpreta o silêncio como estado inalterado.
+     *
+     * Com Reliable, as respostas esperam confirmação do nó intermediário e são reenviadas (ver ArqEndpoint).
+     */
+    class ShelfSensorApplication : public Application
+    {
+        public:
+            static TypeId GetTypeId (void);
+            virtual TypeId GetInstanceTypeId (void) const;
+
+            ShelfSensorApplication();
+            virtual ~ShelfSensorApplication();
+
+            /** \brief Define de onde vêm as leituras do sensor.
+             */
+            void SetReadingSource (Ptr<ShelfReadingSource> source);
+
+            /** \brief Define o estado da prateleira antes da primeira leitura.
+             */
+            void SetInitialState (bool state);
+
+            /** \brief Estado atual da prateleira (true = cheia).
+             */
+            bool GetState () const;
+
+            /** \brief Conta os pacotes e registros em metrics, que deve existir enquanto a aplicação rodar.
+             */
+            void SetMetrics (MetricsRegistry *metrics);
+
+            /** \brief Registra os pacotes e registros recebidos e as respostas enviadas em log, que deve existir
+             * enquanto a aplicação rodar.
+             */
+            void SetEventLog (EventLog *log);
+
+            /** \brief Processa os quadros recebidos do nó intermediário.
+             */
+            void HandleRead (Ptr<Socket> socket);
+
+            /** \brief Bytes ocupados por esta aplicação, incluindo os buffers de envio.
+             */
+            uint32_t GetMemoryUsage () const;
+
+            static const SensorReportStats &GetStats ();
+
+        private:
+            virtual void StartApplication ();
+            virtual void StopApplication ();
+            virtual void DoDispose ();
+
+            /** \brief Envia as respostas acumuladas durante o atraso aleatório.
+             */
+            void FlushReplies ();
+
+            /** \brief Se ainda há leituras do sensor; senão registra o log esvaziado. Só verificar e esvaziar dependem
+             * das leituras, preencher é sempre atendido.
+             */
+            bool HasReadings ();
+
+            uint32_t m_shelfId; /**< Identificador da prateleira no protocolo */
+            uint16_t m_port; /**< Porta em que o sensor recebe e envia quadros */
+            Ipv4Address m_relayAddress; /**< Nó intermediário para o qual as respostas são enviadas */
+            bool m_state; /**< Estado atual da prateleira (true = cheia) */
+            Time m_replyJitter; /**< Atraso máximo das respostas a verificações */
+            Ptr<UniformRandomVariable> m_jitter;
+            EventId m_flushEvent; /**< Envio agendado das respostas atrasadas */
+            bool m_deltaReporting; /**< Responde a verificações apenas quando o estado muda */
+            uint32_t m_heartbeatPolls; /**< Verificações sem resposta antes de um sinal de vida; zero desativa */
+            bool m_lastReported; /**< Último estado informado ao servidor */
+            uint32_t m_pollsSinceReport; /**< Verificações seguidas sem resposta desde a última resposta */
+            bool m_reliable; /**< Respostas enviadas com confirmação e reenvio */
+
+            static SensorReportStats s_stats;
+            Ptr<ShelfReadingSource> m_source;
+            Ptr<Socket> m_socket;
+            FrameWriter m_writer;
+            Ptr<ArqEndpoint> m_arq;
+            MetricsRegistry *m_metrics;
+            EventLog *m_log;
+            NodeMetrics m_metricIds;
+    };
+
+    /** \brief Instala uma ShelfSensorApplication em cada nó de um NodeContainer. O i-ésimo nó recebe
+     * o identificador de prateleira firstShelfId + i, a i-ésima fonte de leituras e o i-ésimo estado inicial.
+     */
+    class ShelfSensorHelper
+    {
+        public:
+            ShelfSensorHelper (Ipv4Address relayAddress, uint16_t port);
+
+            void SetAttribute (std::string name, const AttributeValue &value);
+
+            ApplicationContainer Install (NodeContainer nodes, const std::vector<Ptr<ShelfReadingSource>> &sources,
+                                          const ShelfStateTable &initialStates, uint32_t firstShelfId = 1) const;
+
+        private:
+            ObjectFactory m_factory;
+    };
+}
+
+#endif
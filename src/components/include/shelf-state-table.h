@@ -0,0 +1,74 @@
+#ifndef SHELF_STATE_TABLE_H
+#define SHELF_STATE_TABLE_H
+#include <stdint.h>
+#include <vector>
+
+namespace ns3
+{
+    /** \brief Tabela de estados das prateleiras (true = cheia) compactada em palavras de 64 bits.
+     * As prateleiras são indexadas a partir de 0.
+     *
+     * Os relatos dos sensores podem ser acumulados com Stage() e aplicados de uma vez com
+     * ApplyStaged(), que calcula as discrepâncias (erro de código 5) por XOR e popcount
+     * sobre as palavras tocadas, em vez de comparar prateleira por prateleira. Com AVX2
+     * disponível na compilação, quatro palavras são processadas por instrução.
+     */
+    class ShelfStateTable
+    {
+        public:
+            ShelfStateTable();
+            ShelfStateTable(uint32_t size);
+
+            /** \brief Redimensiona a tabela; prateleiras novas começam vazias e os relatos pendentes são descartados.
+             */
+            void Resize(uint32_t size);
+            uint32_t GetSize() const;
+
+            bool Get(uint32_t shelf) const;
+            void Set(uint32_t shelf, bool full);
+
+            /** \brief Quantidade de prateleiras cheias.
+             */
+            uint32_t CountFull() const;
+
+            /** \brief Acumula o estado relatado pelo sensor de uma prateleira. Retorna false, sem
+             * acumular, se a prateleira já tem um relato pendente; nesse caso ApplyStaged() deve ser chamado antes.
+             */
+            bool Stage(uint32_t shelf, bool reported);
+
+            /** \brief Quantidade de relatos pendentes.
+             */
+            uint32_t GetStagedCount() const;
+
+            /** \brief Aplica todos os relatos pendentes: a tabela passa a refletir os estados relatados
+             * e as prateleiras cujo relato divergia da tabela são acrescentadas a discrepancies, em ordem
+             * crescente. Retorna a quantidade de discrepâncias.
+             */
+            uint32_t ApplyStaged(std::vector<uint32_t> &discrepancies);
+
+            /** \brief Compara duas tabelas de mesmo tamanho e acrescenta a discrepancies as prateleiras
+             * em que diferem. Retorna a quantidade de diferenças.
+             */
+            static uint32_t Compare(const ShelfStateTable &a, const ShelfStateTable &b, std::vector<uint32_t> &discrepancies);
+
+            /** \brief Bytes ocupados pelas palavras da tabela.
+             */
+            uint32_t GetMemoryUsage() const;
+
+        private:
+            /** Palavras por bloco processado de uma vez; os vetores são preenchidos até um múltiplo disso */
+            static const uint32_t WORDS_PER_BLOCK = 4;
+
+            static uint32_t CollectBits(uint64_t word, uint32_t base, std::vector<uint32_t> &out);
+
+            uint32_t m_size; /**< Quantidade de prateleiras */
+            std::vector<uint64_t> m_state; /**< Estado atual, um bit por prateleira */
+            std::vector<uint64_t> m_reported; /**< Estados relatados pendentes */
+            std::vector<uint64_t> m_staged; /**< Máscara das prateleiras com relato pendente */
+            uint32_t m_stagedCount;
+            uint32_t m_dirtyBegin; /**< Primeiro bloco com relato pendente */
+            uint32_t m_dirtyEnd; /**< Um após o último bloco com relato pendente */
+    };
+}
+
+#endif
@@ -0,0 +1,181 @@
+#ifndef WAREHOUSE_PROTOCOL_H
+#define WAREHOUSE_PROTOCOL_H
+#include <cstddef>
+#include <cstdint>
+
+namespace ns3
+{
+    /** \brief Papel de um nó, nos 2 bits mais altos do seu identificador de 32 bits.
+     */
+    enum WarehouseNodeRole : uint32_t
+    {
+        ROLE_SHELF = 0, /**< Sensor de prateleira; o identificador é o número da prateleira, a partir de 1 */
+        ROLE_SERVER = 1,
+        ROLE_RELAY = 2,
+        ROLE_GATEWAY = 3
+    };
+
+    const uint32_t NODE_ROLES = 4;
+    const uint32_t NODE_ROLE_SHIFT = 30;
+    /** Maior índice de um nó dentro do seu papel */
+    const uint32_t NODE_INDEX_MASK = (1u << NODE_ROLE_SHIFT) - 1;
+
+    inline uint32_t MakeNodeId (uint32_t role, uint32_t index)
+    {
+        return (role << NODE_ROLE_SHIFT) | (index & NODE_INDEX_MASK);
+    }
+
+    inline uint32_t GetNodeRole (uint32_t id)
+    {
+        return id >> NODE_ROLE_SHIFT;
+    }
+
+    inline uint32_t GetNodeIndex (uint32_t id)
+    {
+        return id & NODE_INDEX_MASK;
+    }
+
+    /** \brief Identificadores fixos dos nós da rede (ver packet_structure.txt). As prateleiras
+     * (ROLE_SHELF) usam os identificadores 1..NODE_INDEX_MASK.
+     */
+    enum WarehouseNodeId : uint32_t
+    {
+        BROADCAST_ID = 0,
+        SERVER_ID = ROLE_SERVER << NODE_ROLE_SHIFT,
+        GATEWAY_RELAY_ID = ROLE_RELAY << NODE_ROLE_SHIFT,
+        SENSOR_RELAY_ID = (ROLE_RELAY << NODE_ROLE_SHIFT) | 1,
+        GATEWAY_ID = ROLE_GATEWAY << NODE_ROLE_SHIFT
+    };
+
+    /** \brief Códigos de comando carregados no campo command de cada registro.
+     */
+    enum WarehouseCommand : uint8_t
+    {
+        COMMAND_VERIFY = 0,
+        COMMAND_EMPTY = 1,
+        COMMAND_FILL = 2,
+        COMMAND_REPORT = 3, /**< Relatório agregado: dest é o grupo g e o bit b do payload é o estado da prateleira 8g + b + 1 */
+        COMMAND_REPORT_MISSING = 4, /**< Precede o COMMAND_REPORT do grupo dest; bits em 1 são sensores que não responderam */
+        COMMAND_ERROR = 5
+    };
+
+    /** \brief Códigos levados no payload de um registro COMMAND_ERROR.
+     */
+    enum WarehouseErrorCode : uint8_t
+    {
+        ERROR_INVALID_SOURCE = 0, /**< Fonte desconhecida pelo nó */
+        ERROR_INVALID_DEST = 1, /**< Destino não é uma prateleira */
+        ERROR_INVALID_COMMAND = 2, /**< Comando desconhecido */
+        ERROR_SHELF_EMPTY = 3, /**< Tentativa de esvaziar prateleira vazia */
+        ERROR_SHELF_FULL = 4, /**< Tentativa de preencher prateleira cheia */
+        ERROR_INCONSISTENT = 5 /**< Leitura do sensor diverge da tabela do servidor */
+    };
+
+    /** \brief Um registro de prateleira, sucessor do antigo pacote messageData de 4 bytes. Na transmissão,
+     * source, dest e payload são varints (ver EncodeRecord), e um registro entre nós e prateleiras de
+     * índice baixo continua ocupando 4 bytes.
+     */
+    typedef struct
+    {
+        uint32_t source;
+        uint32_t dest;
+        uint8_t command;
+        uint32_t payload;
+    } ShelfRecord;
+
+    /** \brief Cabeçalho de um quadro do protocolo. Campos multi-byte são enviados em big-endian.
+     */
+    typedef struct
+    {
+        uint8_t version;
+        uint8_t flags; /**< Combinação de FRAME_FLAG_* */
+        uint16_t sequence; /**< Número de sequência do quadro, por remetente */
+        uint16_t recordCount; /**< Quantidade de registros que seguem o cabeçalho */
+    } FrameHeader;
+
+    const uint8_t WAREHOUSE_PROTOCOL_VERSION = 2;
+    /** Quadro enviado em difusão para todos os sensores; os demais nós o descartam */
+    const uint8_t FRAME_FLAG_BROADCAST = 0x01;
+    /** Quadro numerado por vizinho que espera confirmação (ver ArqEndpoint) */
+    const uint8_t FRAME_FLAG_RELIABLE = 0x02;
+    /** Confirmação cumulativa sem registros: sequence é o próximo número esperado pelo receptor */
+    const uint8_t FRAME_FLAG_ACK = 0x04;
+    /** Aviso sem registros: o remetente desistiu dos quadros anteriores a sequence e o receptor deve pular até ele */
+    const uint8_t FRAME_FLAG_FORWARD = 0x08;
+    const uint32_t FRAME_HEADER_SIZE = 6;
+    /** Registro com source, dest e payload de um byte cada, o tamanho fixo da versão 1 */
+    const uint32_t MIN_RECORD_SIZE = 4;
+    /** Registro com source, dest e payload de 5 bytes cada */
+    const uint32_t MAX_RECORD_SIZE = 16;
+    /** Maior payload UDP que cabe em um MTU de 1500 bytes sem fragmentação IP */
+    const uint32_t MAX_FRAME_SIZE = 1472;
+    const uint32_t MAX_RECORDS_PER_FRAME = (MAX_FRAME_SIZE - FRAME_HEADER_SIZE) / MIN_RECORD_SIZE;
+
+    /** \brief Quadro do protocolo: um cabeçalho seguido de vários registros de prateleira.
+     * Os registros ficam em um vetor de capacidade fixa, de modo que um quadro pode ser decodificado
+     * em uma variável local sem nenhuma alocação; apenas os header.recordCount primeiros são válidos.
+     */
+    typedef struct
+    {
+        FrameHeader header;
+        ShelfRecord records[MAX_RECORDS_PER_FRAME];
+    } WarehouseFrame;
+
+    /** \brief Bytes ocupados por um identificador de nó: o varint de índice * 4 + papel, de 1 a 5 bytes.
+     */
+    uint32_t GetNodeIdSize (uint32_t id);
+
+    /** \brief Bytes ocupados pelo registro na transmissão, de MIN_RECORD_SIZE a MAX_RECORD_SIZE.
+     */
+    uint32_t GetRecordSize (const ShelfRecord &record);
+
+    /** \brief Escreve os 6 bytes do cabeçalho no início de buffer.
+     */
+    void EncodeFrameHeader (const FrameHeader &header, uint8_t *buffer);
+
+    /** \brief Escreve o registro em buffer, que deve ter ao menos GetRecordSize(record) bytes: source e dest
+     * como identificadores de nó, o byte de command e o payload como varint. Retorna os bytes escritos.
+     */
+    uint32_t EncodeRecord (const ShelfRecord &record, uint8_t *buffer);
+
+    /** \brief Serializa o quadro em buffer. Retorna o número de bytes escritos, ou 0 se não couber em capacity
+     * ou se header.recordCount for maior que MAX_RECORDS_PER_FRAME.
+     */
+    uint32_t EncodeFrame (const WarehouseFrame &frame, uint8_t *buffer, uint32_t capacity);
+
+    /** \brief Lê um quadro de buffer. Retorna false se a versão for desconhecida, se um varint for inválido
+     * ou se o tamanho não corresponder exatamente aos registros anunciados no cabeçalho.
+     */
+    bool DecodeFrame (const uint8_t *buffer, uint32_t size, WarehouseFrame &frame);
+
+    /** \brief Contadores de tráfego de aplicação, usados para comparar o protocolo em quadros
+     * com o formato antigo de um registro por datagrama.
+     */
+    typedef struct
+    {
+        uint64_t datagrams; /**< Datagramas UDP enviados */
+        uint64_t records; /**< Registros de prateleira carregados nesses datagramas */
+        uint64_t payloadBytes; /**< Bytes de payload UDP enviados */
+    } WireStats;
+
+    /** Sobrecarga por datagrama em uma rede 802.11: UDP(8) + IPv4(20) + LLC/SNAP(8) + MAC 802.11(26) + FCS(4) */
+    const uint32_t DATAGRAM_OVERHEAD = 66;
+
+    /** \brief Bytes no ar (payload + cabeçalhos de camadas inferiores) do tráfego contado em stats.
+     */
+    uint64_t GetAirBytes (const WireStats &stats);
+
+    /** Tamanho do antigo messageData */
+    const uint32_t LEGACY_RECORD_SIZE = 4;
+
+    /** \brief Bytes no ar que o formato antigo (um messageData de 4 bytes por datagrama) gastaria
+     * para carregar os mesmos registros.
+     */
+    uint64_t GetLegacyAirBytes (const WireStats &stats);
+
+    /** \brief Nome do comando, para relatórios.
+     */
+    const char *GetCommandName (uint8_t command);
+}
+
+#endif
@@ -0,0 +1,188 @@
+#ifndef WAREHOUSE_RELAY_APPLICATION_H
+#define WAREHOUSE_RELAY_APPLICATION_H
+#include "ns3/application.h"
+#include "ns3/callback.h"
+#include "ns3/socket.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "frame-writer.h"
+#include "event-log.h"
+#include <vector>
+
+namespace ns3
+{
+    /** \brief Nó intermediário entre o servidor (uplink) e um grupo de nós (sensores ou gateway).
+     *
+     * O encaminhamento usa duas tabelas montadas uma vez na configuração:
+     *   - rotas: identificador de nó -> próximo salto, para os nós abaixo do intermediário, uma tabela por
+     *     papel indexada pelo índice do nó (ver MakeNodeId);
+     *   - tratadores: código de comando -> função, para os registros vindos do uplink.
+     * Um registro vindo do uplink é entregue ao tratador do seu comando (ou ao tratador padrão);
+     * um registro vindo de um nó com rota é repassado ao uplink; qualquer outra fonte recebe
+     * um erro ERROR_INVALID_SOURCE. Todas as consultas são por índice, em tempo constante.
+     *
+     * Com AggregationWindow maior que zero, cada verificação vinda do uplink abre uma rodada: as respostas
+     * dos nós abaixo a essa verificação são retidas e, quando todos respondem ou a janela termina, seguem
+     * ao uplink em um único quadro, com um COMMAND_REPORT por grupo de 8 nós (estados em bits) precedido
+     * de um COMMAND_REPORT_MISSING nos grupos em que algum nó não respondeu.
+     *
+     * Com Reliable, os quadros unicast enviados pelo intermediário esperam confirmação (ver ArqEndpoint).
+     *
+     * Com o servidor dividido em vários nós, AddShard indica o uplink dono de cada intervalo de prateleiras. Os
+     * registros vindos de baixo seguem para o dono da prateleira da fonte (ShardBy=Source, sensores) ou do
+     * payload (ShardBy=Payload, alvo dos comandos do gateway), e os relatórios agregados para o dono do grupo;
+     * as prateleiras sem dono seguem para UplinkAddress.
+     *
+     * Intermediários podem ser encadeados: na topologia de corredores, o intermediário dos sensores tem como
+     * próximo salto de cada prateleira o ponto de acesso do seu corredor, que roda outro intermediário (com um
+     * NodeId de papel ROLE_RELAY próprio) e agrega as respostas da sua célula. Os relatórios desses intermediários
+     * seguem ao uplink como os registros de qualquer nó com rota.
+     */
+    class WarehouseRelayApplication : public Application
+    {
+        public:
+            /** \brief Tratador de um comando: recebe o registro e o endereço de quem enviou o quadro.
+             */
+            typedef Callback<void, const ShelfRecord &, Ipv4Address> RecordHandler;
+
+            /** \brief Campo do registro que identifica a prateleira, para a escolha do uplink.
+             */
+            enum ShardKey
+            {
+                SHARD_BY_SOURCE,
+                SHARD_BY_PAYLOAD
+            };
+
+            static TypeId GetTypeId (void);
+            virtual TypeId GetInstanceTypeId (void) const;
+
+            WarehouseRelayApplication();
+            virtual ~WarehouseRelayApplication();
+
+            /** \brief Registros destinados a nodeId, ou vindos dele, passam por nextHop.
+             */
+            void AddRoute (uint32_t nodeId, Ipv4Address nextHop);
+
+            /** \brief Registros vindos de baixo sobre as prateleiras firstId a lastId seguem para uplink.
+             */
+            void AddShard (uint32_t firstId, uint32_t lastId, Ipv4Address uplink);
+
+            /** \brief Broadcast envia uma cópia para o broadcast da sub-rede address em vez de 255.255.255.255, que o
+             * ns-3 troca pelo broadcast da sub-rede do próprio intermediário. Necessário quando os sensores estão em
+             * sub-redes distintas da do intermediário no mesmo enlace; chame uma vez por sub-rede.
+             */
+            void AddBroadcastAddress (Ipv4Address address);
+
+            /** \brief Define o tratador dos registros com o comando command vindos do uplink.
+             */
+            void SetCommandHandler (uint8_t command, RecordHandler handler);
+
+            /** \brief Tratador dos comandos sem tratador próprio. Por padrão, RejectCommand.
+             */
+            void SetDefaultHandler (RecordHandler handler);
+
+            /** \brief Registra os pacotes e registros recebidos em log, que deve existir enquanto a aplicação rodar.
+             */
+            void SetEventLog (EventLog *log);
+
+            /** \brief Conta os pacotes, registros e erros em metrics, que deve existir enquanto a aplicação rodar.
+             */
+            void SetMetrics (MetricsRegistry *metrics);
+
+            /** \brief Tratadores prontos para uso com SetCommandHandler/SetDefaultHandler.
+             * ForwardToDest repassa ao próximo salto do destino do registro, ou responde ERROR_INVALID_DEST;
+             * ForwardToAll repassa uma cópia a cada próximo salto distinto; Broadcast envia um único quadro
+             * em difusão (um por sub-rede de AddBroadcastAddress), recebido por todos os sensores; Drop descarta; RejectCommand responde ERROR_INVALID_COMMAND.
+             */
+            void ForwardToDest (const ShelfRecord &record, Ipv4Address sender);
+            void ForwardToAll (const ShelfRecord &record, Ipv4Address sender);
+            void Broadcast (const ShelfRecord &record, Ipv4Address sender);
+            void Drop (const ShelfRecord &record, Ipv4Address sender);
+            void RejectCommand (const ShelfRecord &record, Ipv4Address sender);
+
+            /** \brief Enfileira record para nextHop no quadro em construção. Para uso pelos tratadores.
+             */
+            void Forward (Ipv4Address nextHop, const ShelfRecord &record);
+
+            /** \brief Responde a to com um registro COMMAND_ERROR de código code, destinado a dest.
+             */
+            void SendError (Ipv4Address to, uint32_t dest, uint8_t code);
+
+            /** \brief Processa os quadros recebidos.
+             */
+            void HandleRead (Ptr<Socket> socket);
+
+            /** \brief Bytes ocupados pela aplicação, incluindo as tabelas e os buffers de envio.
+             */
+            uint32_t GetMemoryUsage () const;
+
+        private:
+            virtual void StartApplication ();
+            virtual void StopApplication ();
+            virtual void DoDispose ();
+
+            /** \brief Abre uma rodada de agregação para a verificação sendo processada, fechando a anterior.
+             */
+            void OpenRound ();
+
+            /** \brief Retém a resposta de um nó à rodada aberta. Retorna false se ela não pertence à rodada.
+             */
+            bool Aggregate (const ShelfRecord &record);
+
+            /** \brief Enfileira o relatório da rodada aberta para o uplink e fecha a rodada.
+             */
+            void CloseRound ();
+
+            /** \brief Fim da janela de agregação.
+             */
+            void RoundTimeout ();
+
+            /** \brief Uplink dono da prateleira id.
+             */
+            Ipv4Address GetUplink (uint32_t id) const;
+
+            /** \brief Prateleira que escolhe o uplink de um registro vindo de baixo: a do ShardBy, ou a primeira do
+             * grupo nos relatórios agregados de outro intermediário.
+             */
+            uint32_t GetShardShelf (const ShelfRecord &record) const;
+
+            /** \brief Índice em m_nextHops do nó id, ou NO_ROUTE.
+             */
+            uint32_t GetRoute (uint32_t id) const;
+
+            static const uint32_t NO_ROUTE = 0xffffffff;
+
+            uint32_t m_nodeId; /**< Identificador deste intermediário, fonte das mensagens de erro */
+            uint32_t m_uplinkId; /**< Identificador do nó acima do intermediário (o servidor) */
+            Ipv4Address m_uplinkAddress;
+            ShardKey m_shardKey;
+            std::vector<uint32_t> m_shardRoutes; /**< Índice em m_uplinks por prateleira, ou NO_ROUTE para UplinkAddress */
+            std::vector<Ipv4Address> m_uplinks; /**< Servidores donos de um intervalo de prateleiras */
+            uint16_t m_port;
+            std::vector<uint32_t> m_routes[NODE_ROLES]; /**< Índice em m_nextHops por papel e índice de nó, ou NO_ROUTE */
+            std::vector<Ipv4Address> m_nextHops; /**< Próximos saltos distintos abaixo do intermediário */
+            std::vector<Ipv4Address> m_broadcasts; /**< Destinos da difusão; vazio usa Ipv4Address::GetBroadcast() */
+            RecordHandler m_handlers[256]; /**< Tratador por código de comando; nulo usa m_defaultHandler */
+            RecordHandler m_defaultHandler;
+            LatencyTag m_origin; /**< Origem do quadro sendo processado, herdada pelos registros gerados */
+            Time m_aggregationWindow; /**< Duração máxima de uma rodada de agregação; zero desativa a agregação */
+            bool m_roundOpen;
+            LatencyTag m_roundOrigin; /**< Origem da verificação que abriu a rodada */
+            std::vector<uint8_t> m_expected; /**< Prateleiras com rota, em bits por grupo de 8 identificadores a partir de 1 */
+            std::vector<uint8_t> m_replied; /**< Nós que já responderam na rodada aberta */
+            std::vector<uint8_t> m_states; /**< Estados relatados na rodada aberta */
+            uint32_t m_roundPending; /**< Respostas que ainda faltam na rodada aberta */
+            uint32_t m_expectedCount;
+            EventId m_roundEvent;
+            EventLog *m_log;
+            MetricsRegistry *m_metrics;
+            NodeMetrics m_metricIds;
+            bool m_reliable; /**< Quadros unicast enviados com confirmação e reenvio */
+            Ptr<Socket> m_socket;
+            FrameWriter m_writer;
+            Ptr<ArqEndpoint> m_arq;
+    };
+}
+
+#endif
@@ -0,0 +1,183 @@
+#ifndef WAREHOUSE_SERVER_APPLICATION_H
+#define WAREHOUSE_SERVER_APPLICATION_H
+#include "ns3/application.h"
+#include "ns3/socket.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "frame-writer.h"
+#include "shelf-state-table.h"
+#include "latency-collector.h"
+#include "event-log.h"
+#include <vector>
+
+namespace ns3
+{
+    /** \brief Contadores do envio de comandos aos sensores, somados de todos os servidores da simulação.
+     */
+    typedef struct
+    {
+        uint64_t commands; /**< Comandos de esvaziar e preencher aceitos para os sensores */
+        uint64_t batches; /**< Quadros de comandos enviados ao intermediário dos sensores */
+        uint64_t batchedCommands; /**< Comandos que seguiram em um quadro junto com outros */
+        uint64_t coalesced; /**< Comandos que se anularam (preencher e esvaziar a mesma prateleira) antes do envio */
+    } ServerBatchStats;
+
+    /** \brief Servidor: mantém a tabela de estados das prateleiras, valida os comandos do gateway, repassa os
+     * aceitos aos sensores e confere as respostas dos sensores com a tabela.
+     *
+     * Os comandos aceitos para os sensores não são enviados um a um: ficam em um lote por até BatchWindow e
+     * seguem juntos em um quadro por intermediário. Com Coalesce, um comando que desfaz outro ainda no lote
+     * (preencher e depois esvaziar a mesma prateleira, ou o contrário) remove os dois do lote, e o gateway
+     * recebe o sucesso de ambos sem que o sensor seja acionado, pois o estado final da prateleira é o mesmo.
+     *
+     * A cada PollPeriod o servidor inicia uma rodada de verificação; a rodada termina quando todos os sensores
+     * respondem, diretamente ou em um relatório agregado do intermediário.
+     *
+     * O estado pode ser dividido entre vários servidores, cada um dono de um intervalo contíguo de prateleiras
+     * (SetInitialStates); os intermediários entregam a cada um os comandos e relatos das suas prateleiras. Um
+     * servidor com PollPeriod zero não inicia verificações: as respostas às verificações de outro servidor
+     * abrem as suas rodadas.
+     */
+    class WarehouseServerApplication : public Application
+    {
+        public:
+            static TypeId GetTypeId (void);
+            virtual TypeId GetInstanceTypeId (void) const;
+
+            WarehouseServerApplication();
+            virtual ~WarehouseServerApplication();
+
+            /** \brief Estado inicial das prateleiras firstShelf a firstShelf + count - 1 (identificadores a partir
+             * de 1), as únicas de que este servidor é dono; count = 0 vai até o fim de states.
+             */
+            void SetInitialStates (const ShelfStateTable &states, uint32_t firstShelf = 1, uint32_t count = 0);
+
+            uint32_t GetFirstShelf () const;
+            uint32_t GetShelfCount () const;
+
+            /** \brief Registra os pacotes e registros recebidos em log, que deve existir enquanto a aplicação rodar.
+             */
+            void SetEventLog (EventLog *log);
+
+            /** \brief Acumula a latência das respostas às verificações em latency, que deve existir enquanto a aplicação rodar.
+             */
+            void SetLatencyCollector (LatencyCollector *latency);
+
+            /** \brief Conta os pacotes, registros, erros e discrepâncias em metrics, que deve existir enquanto a aplicação rodar.
+             */
+            void SetMetrics (MetricsRegistry *metrics);
+
+            /** \brief Processa os quadros recebidos dos intermediários.
+             */
+            void HandleRead (Ptr<Socket> socket);
+
+            /** \brief Tabela de estados segundo o servidor, a partir da prateleira GetFirstShelf().
+             */
+            const ShelfStateTable &GetStateTable () const;
+
+            /** \brief Instante da última resposta do sensor da prateleira GetFirstShelf() + shelf.
+             */
+            Time GetLastHeard (uint32_t shelf) const;
+
+            uint32_t GetVerifyRounds () const;
+
+            /** \brief Duração, em ms, de cada rodada de verificação completa, isto é, em que todas as prateleiras
+             * responderam. Com DeltaReporting nos sensores, os inalterados ficam em silêncio e nenhuma rodada se completa.
+             */
+            const std::vector<double> &GetVerifyCompletion () const;
+
+            /** \brief Respostas que faltaram nos relatórios agregados.
+             */
+            uint32_t GetVerifyMissing () const;
+
+            static const ServerBatchStats &GetStats ();
+
+        private:
+            virtual void StartApplication ();
+            virtual void StopApplication ();
+            virtual void DoDispose ();
+
+            /** \brief Comando aceito à espera do envio no lote */
+            typedef struct
+            {
+                Ipv4Address nextHop;
+                ShelfRecord record;
+                LatencyTag origin; /**< Origem do comando do gateway */
+                bool live; /**< false se foi anulado por outro comando */
+            } BatchedCommand;
+
+            /** \brief Inicia uma rodada de verificação e agenda a próxima.
+             */
+            void Verify ();
+
+            void HandleGatewayCommand (const ShelfRecord &data, Ipv4Address sender);
+
+            /** \brief Resposta de um sensor, vinda diretamente ou desagregada de um relatório do intermediário.
+             */
+            void HandleSensorReport (const ShelfRecord &data);
+
+            /** \brief Aplica à tabela os relatos acumulados dos sensores e responde ao gateway.
+             */
+            void ApplySensorReports ();
+
+            /** \brief Põe no lote o comando record para o sensor, ou o anula com o comando oposto já no lote.
+             */
+            void QueueCommand (const ShelfRecord &record);
+
+            /** \brief Envia os comandos do lote.
+             */
+            void FlushBatch ();
+
+            /** \brief A prateleira shelf pertence a este servidor.
+             */
+            bool Owns (uint32_t shelf) const;
+
+            /** \brief Responde ao gateway o sucesso de um comando sobre a prateleira shelf.
+             */
+            void SendSuccess (uint32_t shelf, uint8_t command, const LatencyTag &origin);
+
+            /** \brief Envia a to um erro de código code para o gateway.
+             */
+            void SendError (Ipv4Address to, uint8_t code);
+
+            uint16_t m_port;
+            Ipv4Address m_gatewayRelayAddress; /**< Intermediário entre gateway e servidor */
+            Ipv4Address m_sensorRelayAddress; /**< Intermediário entre servidor e sensores */
+            Time m_pollPeriod; /**< Intervalo entre verificações; zero desativa */
+            Time m_batchWindow; /**< Espera máxima de um comando no lote; zero envia ao fim de cada quadro recebido */
+            bool m_coalesce;
+            bool m_reliable;
+            ShelfStateTable m_table; /**< Estado de cada prateleira segundo o servidor, um bit por prateleira */
+            uint32_t m_firstShelf; /**< Primeira prateleira deste servidor */
+            uint32_t m_shelves; /**< Prateleiras deste servidor */
+            std::vector<uint32_t> m_discrepancies;
+            std::vector<ShelfRecord> m_pendingReports; /**< Relatos acumulados em m_table, ainda não aplicados */
+            LatencyTag m_origin; /**< Origem do quadro sendo processado */
+            std::vector<Time> m_lastHeard; /**< Última resposta de cada sensor, para verificar sinais de vida */
+            uint32_t m_reportMissingGroup; /**< Grupo do último registro COMMAND_REPORT_MISSING ainda não usado, ou NO_GROUP */
+            uint8_t m_reportMissingMask;
+            Time m_verifyStart; /**< Início da rodada de verificação atual */
+            uint32_t m_verifyReplies;
+            uint32_t m_verifyRounds;
+            std::vector<double> m_verifyCompletion;
+            uint32_t m_verifyMissing;
+            std::vector<BatchedCommand> m_batch;
+            std::vector<int32_t> m_batchIndex; /**< Posição em m_batch do comando vivo de cada prateleira, ou -1 */
+            EventId m_batchEvent;
+            EventId m_verifyEvent;
+            EventLog *m_log;
+            LatencyCollector *m_latency;
+            MetricsRegistry *m_metrics;
+            NodeMetrics m_metricIds;
+            Ptr<Socket> m_socket;
+            FrameWriter m_writer;
+            Ptr<ArqEndpoint> m_arq;
+
+            static const uint32_t NO_GROUP = 0xffffffff;
+
+            static ServerBatchStats s_stats;
+    };
+}
+
+#endif
@@ -0,0 +1,420 @@
+#include "include/instance-loader.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ns3
+{
+    /** Layout do formato binário. Todos os inteiros são little-endian. */
+    static const char BINARY_MAGIC[4] = {'W', 'H', 'T', 'R'};
+    static const uint16_t BINARY_VERSION = 1;
+    static const uint32_t BINARY_HEADER_SIZE = 24;
+
+    static uint64_t Align(uint64_t offset, uint64_t alignment)
+    {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    static uint32_t ReadLe32(const char *data)
+    {
+        const uint8_t *b = (const uint8_t *)data;
+        return b[0] | (b[1] << 8) | (b[2] << 16) | ((uint32_t)b[3] << 24);
+    }
+
+    static void WriteLe32(char *data, uint32_t value)
+    {
+        data[0] = value & 0xff;
+        data[1] = (value >> 8) & 0xff;
+        data[2] = (value >> 16) & 0xff;
+        data[3] = (value >> 24) & 0xff;
+    }
+
+    RowCursor::RowCursor()
+    {
+        m_encoding = TEXT;
+        m_cursor = 0;
+        m_end = 0;
+        m_index = 0;
+        m_count = 0;
+    }
+
+    RowCursor::RowCursor(const char *begin, const char *end)
+    {
+        m_encoding = TEXT;
+        m_cursor = begin;
+        m_end = end;
+        m_index = 0;
+        m_count = 0;
+    }
+
+    RowCursor::RowCursor(Encoding encoding, const char *data, uint32_t count)
+    {
+        m_encoding = encoding;
+        m_cursor = data;
+        m_end = data;
+        m_index = 0;
+        m_count = count;
+    }
+
+    void RowCursor::SkipSpaces()
+    {
+        while (m_cursor < m_end && (*m_cursor == ' ' || *m_cursor == '\t' || *m_cursor == '\r'))
+        {
+            m_cursor++;
+        }
+    }
+
+    /** Conversão sem locale: apenas sinal opcional seguido de dígitos decimais. Qualquer outro
+     * caractere encerra o número e é pulado, para que um caractere inválido não trave a leitura.
+     */
+    int32_t RowCursor::Parse(const char **cursor) const
+    {
+        const char *c = *cursor;
+        bool negative = false;
+        if (c < m_end && (*c == '-' || *c == '+'))
+        {
+            negative = *c == '-';
+            c++;
+        }
+        int32_t value = 0;
+        while (c < m_end && (unsigned)(*c - '0') < 10)
+        {
+            value = value * 10 + (*c - '0');
+            c++;
+        }
+        while (c < m_end && *c != ' ' && *c != '\t' && *c != '\r')
+        {
+            c++;
+        }
+        *cursor = c;
+        return negative ? -value : value;
+    }
+
+    int32_t RowCursor::ReadBinary() const
+    {
+        switch (m_encoding)
+        {
+        case BITS:
+            return (m_cursor[m_index >> 3] >> (m_index & 7)) & 1;
+        case UINT8:
+            return (uint8_t)m_cursor[m_index];
+        case UINT32:
+            return ReadLe32(m_cursor + 4 * m_index);
+        default:
+            return 0;
+        }
+    }
+
+    bool RowCursor::HasNext()
+    {
+        if (m_encoding != TEXT)
+        {
+            return m_index < m_count;
+        }
+        SkipSpaces();
+        return m_cursor < m_end;
+    }
+
+    int32_t RowCursor::Peek()
+    {
+        if (m_encoding != TEXT)
+        {
+            return ReadBinary();
+        }
+        SkipSpaces();
+        const char *c = m_cursor;
+        return Parse(&c);
+    }
+
+    int32_t RowCursor::Next()
+    {
+        if (m_encoding != TEXT)
+        {
+            int32_t value = ReadBinary();
+            m_index++;
+            return value;
+        }
+        SkipSpaces();
+        return Parse(&m_cursor);
+    }
+
+    InstanceFile::InstanceFile()
+    {
+        m_data = 0;
+        m_size = 0;
+        m_binary = false;
+        m_shelfCount = 0;
+        m_gatewayCount = 0;
+        m_bytesPerShelf = 0;
+        m_countsOffset = 0;
+        m_readingsOffset = 0;
+        m_commandsOffset = 0;
+        m_targetsOffset = 0;
+    }
+
+    InstanceFile::~InstanceFile()
+    {
+        Close();
+    }
+
+    void InstanceFile::Close()
+    {
+        if (m_data != 0)
+        {
+            munmap((void *)m_data, m_size);
+            m_data = 0;
+            m_size = 0;
+        }
+        m_rows.clear();
+        m_binary = false;
+    }
+
+    bool InstanceFile::Open(const std::string &path)
+    {
+        Close();
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            m_error = std::strerror(errno);
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) < 0)
+        {
+            m_error = std::strerror(errno);
+            close(fd);
+            return false;
+        }
+        if (st.st_size == 0)
+        {
+            m_error = "arquivo vazio";
+            close(fd);
+            return false;
+        }
+        void *data = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED)
+        {
+            m_error = std::strerror(errno);
+            return false;
+        }
+        madvise(data, st.st_size, MADV_SEQUENTIAL);
+        m_data = (const char *)data;
+        m_size = st.st_size;
+
+        m_binary = m_size >= sizeof(BINARY_MAGIC) && memcmp(m_data, BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0;
+        if (!(m_binary ? IndexBinary() : IndexText()))
+        {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    bool InstanceFile::IndexText()
+    {
+        // Indexa as linhas não vazias; os inteiros só são lidos pelos cursores
+        const char *end = m_data + m_size;
+        const char *line = m_data;
+        while (line < end)
+        {
+            const char *newline = (const char *)memchr(line, '\n', end - line);
+            const char *lineEnd = newline ? newline : end;
+            RowCursor probe(line, lineEnd);
+            if (probe.HasNext())
+            {
+                m_rows.push_back(std::make_pair(line - m_data, lineEnd - m_data));
+            }
+            line = lineEnd + 1;
+        }
+
+        if (m_rows.size() < 3)
+        {
+            m_error = "a instância precisa de ao menos uma prateleira e das duas linhas do gateway";
+            return false;
+        }
+        return true;
+    }
+
+    bool InstanceFile::IndexBinary()
+    {
+        if (m_size < BINARY_HEADER_SIZE || (uint8_t)m_data[4] != BINARY_VERSION)
+        {
+            m_error = "versão do formato binário desconhecida";
+            return false;
+        }
+        m_shelfCount = ReadLe32(m_data + 8);
+        uint32_t timestepCount = ReadLe32(m_data + 12);
+        m_gatewayCount = ReadLe32(m_data + 16);
+
+        m_bytesPerShelf = Align((timestepCount + 7) / 8, 8);
+        m_countsOffset = BINARY_HEADER_SIZE;
+        m_readingsOffset = Align(m_countsOffset + 4 * (uint64_t)m_shelfCount, 8);
+        m_commandsOffset = m_readingsOffset + (uint64_t)m_shelfCount * m_bytesPerShelf;
+        m_targetsOffset = Align(m_commandsOffset + m_gatewayCount, 4);
+        if (m_shelfCount == 0 || m_targetsOffset + 4 * (uint64_t)m_gatewayCount > m_size)
+        {
+            m_error = "arquivo binário truncado ou sem prateleiras";
+            return false;
+        }
+        for (uint32_t i = 0; i < m_shelfCount; i++)
+        {
+            if (ReadLe32(m_data + m_countsOffset + 4 * i) > timestepCount)
+            {
+                m_error = "quantidade de leituras de uma prateleira maior que a do cabeçalho";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const std::string &InstanceFile::GetError() const
+    {
+        return m_error;
+    }
+
+    bool InstanceFile::IsBinary() const
+    {
+        return m_binary;
+    }
+
+    uint32_t InstanceFile::GetShelfCount() const
+    {
+        return m_binary ? m_shelfCount : m_rows.size() - 2;
+    }
+
+    RowCursor InstanceFile::GetShelfRow(uint32_t shelf) const
+    {
+        if (m_binary)
+        {
+            uint32_t count = ReadLe32(m_data + m_countsOffset + 4 * shelf);
+            return RowCursor(RowCursor::BITS, m_data + m_readingsOffset + (uint64_t)shelf * m_bytesPerShelf, count);
+        }
+        return RowCursor(m_data + m_rows[shelf].first, m_data + m_rows[shelf].second);
+    }
+
+    RowCursor InstanceFile::GetGatewayCommands() const
+    {
+        if (m_binary)
+        {
+            return RowCursor(RowCursor::UINT8, m_data + m_commandsOffset, m_gatewayCount);
+        }
+        return RowCursor(m_data + m_rows[m_rows.size() - 2].first, m_data + m_rows[m_rows.size() - 2].second);
+    }
+
+    RowCursor InstanceFile::GetGatewayTargets() const
+    {
+        if (m_binary)
+        {
+            return RowCursor(RowCursor::UINT32, m_data + m_targetsOffset, m_gatewayCount);
+        }
+        return RowCursor(m_data + m_rows[m_rows.size() - 1].first, m_data + m_rows[m_rows.size() - 1].second);
+    }
+
+    bool InstanceFile::WriteBinary(const std::string &path)
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+        {
+            m_error = std::strerror(errno);
+            return false;
+        }
+
+        // Primeira passagem: quantidade de leituras de cada prateleira e de comandos do gateway
+        uint32_t shelfCount = GetShelfCount();
+        std::vector<char> counts(4 * shelfCount);
+        uint32_t timestepCount = 0;
+        for (uint32_t i = 0; i < shelfCount; i++)
+        {
+            RowCursor row = GetShelfRow(i);
+            uint32_t count = 0;
+            while (row.HasNext())
+            {
+                row.Next();
+                count++;
+            }
+            WriteLe32(&counts[4 * i], count);
+            timestepCount = count > timestepCount ? count : timestepCount;
+        }
+        RowCursor commands = GetGatewayCommands();
+        RowCursor targets = GetGatewayTargets();
+        uint32_t gatewayCount = 0;
+        for (RowCursor c = commands, t = targets; c.HasNext() && t.HasNext(); c.Next(), t.Next())
+        {
+            gatewayCount++;
+        }
+
+        char header[BINARY_HEADER_SIZE] = {0};
+        memcpy(header, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+        header[4] = BINARY_VERSION;
+        WriteLe32(header + 8, shelfCount);
+        WriteLe32(header + 12, timestepCount);
+        WriteLe32(header + 16, gatewayCount);
+        out.write(header, sizeof(header));
+        out.write(counts.data(), counts.size());
+
+        // Segunda passagem: leituras compactadas em bits, uma prateleira por vez
+        uint64_t offset = BINARY_HEADER_SIZE + counts.size();
+        std::vector<char> padding(8, 0);
+        out.write(padding.data(), Align(offset, 8) - offset);
+        uint32_t bytesPerShelf = Align((timestepCount + 7) / 8, 8);
+        std::vector<char> bits(bytesPerShelf);
+        for (uint32_t i = 0; i < shelfCount; i++)
+        {
+            std::fill(bits.begin(), bits.end(), 0);
+            RowCursor row = GetShelfRow(i);
+            for (uint32_t t = 0; row.HasNext(); t++)
+            {
+                if (row.Next() != 0)
+                {
+                    bits[t >> 3] |= 1 << (t & 7);
+                }
+            }
+            out.write(bits.data(), bits.size());
+        }
+
+        // Colunas do gateway: comandos em um byte, alvos em quatro
+        std::vector<char> column(gatewayCount);
+        for (uint32_t i = 0; i < gatewayCount; i++)
+        {
+            column[i] = commands.Next();
+        }
+        out.write(column.data(), column.size());
+        out.write(padding.data(), Align(gatewayCount, 4) - gatewayCount);
+        column.resize(4 * gatewayCount);
+        for (uint32_t i = 0; i < gatewayCount; i++)
+        {
+            WriteLe32(&column[4 * i], targets.Next());
+        }
+        out.write(column.data(), column.size());
+
+        out.close();
+        if (out.fail())
+        {
+            m_error = std::strerror(errno);
+            return false;
+        }
+        return true;
+    }
+
+    MappedReadingSource::MappedReadingSource(Ptr<InstanceFile> file, uint32_t shelf)
+    {
+        m_file = file;
+        m_row = file->GetShelfRow(shelf);
+    }
+
+    bool MappedReadingSource::HasNext() const
+    {
+        return m_row.HasNext();
+    }
+
+    bool MappedReadingSource::Next()
+    {
+        return m_row.Next() != 0;
+    }
+}
@@ -0,0 +1,81 @@
+#include "include/latency-collector.h"
+#include "include/warehouse-protocol.h"
+#include <algorithm>
+
+namespace ns3
+{
+    /** Limite inferior da faixa do histograma, em milissegundos */
+    static const double HISTOGRAM_FIRST_BUCKET = 0.1;
+
+    static double Percentile(std::vector<double> &sorted, double p)
+    {
+        uint32_t rank = (uint32_t)(p / 100.0 * sorted.size() + 0.999999);
+        rank = rank < 1 ? 1 : rank;
+        return sorted[rank - 1];
+    }
+
+    void LatencyCollector::Record(uint8_t command, Time latency, uint8_t hops)
+    {
+        Samples &samples = m_samples[command];
+        samples.latencies.push_back(latency.GetSeconds() * 1000.0);
+        samples.hops += hops;
+    }
+
+    uint32_t LatencyCollector::GetCount(uint8_t command) const
+    {
+        std::map<uint8_t, Samples>::const_iterator it = m_samples.find(command);
+        return it == m_samples.end() ? 0 : it->second.latencies.size();
+    }
+
+    double LatencyCollector::GetPercentile(uint8_t command, double p) const
+    {
+        std::map<uint8_t, Samples>::const_iterator it = m_samples.find(command);
+        if (it == m_samples.end() || it->second.latencies.empty())
+        {
+            return 0;
+        }
+        std::vector<double> sorted = it->second.latencies;
+        std::sort(sorted.begin(), sorted.end());
+        return Percentile(sorted, p);
+    }
+
+    void LatencyCollector::Print(std::ostream &os) const
+    {
+        for (std::map<uint8_t, Samples>::const_iterator it = m_samples.begin(); it != m_samples.end(); it++)
+        {
+            std::vector<double> sorted = it->second.latencies;
+            if (sorted.empty())
+            {
+                continue;
+            }
+            std::sort(sorted.begin(), sorted.end());
+            double sum = 0;
+            for (uint32_t i = 0; i < sorted.size(); i++)
+            {
+                sum += sorted[i];
+            }
+
+            os << "Latência (" << GetCommandName(it->first) << "): " << sorted.size() << " amostras, média " << sum / sorted.size()
+               << " ms, p50 " << Percentile(sorted, 50) << " ms, p95 " << Percentile(sorted, 95) << " ms, p99 " << Percentile(sorted, 99)
+               << " ms, máximo " << sorted.back() << " ms, " << (double)it->second.hops / sorted.size() << " saltos em média" << std::endl;
+
+            // histograma: a primeira faixa vai até 0,1 ms e cada faixa seguinte tem o dobro do limite superior
+            double limit = HISTOGRAM_FIRST_BUCKET;
+            uint32_t i = 0;
+            while (i < sorted.size())
+            {
+                uint32_t count = 0;
+                while (i < sorted.size() && sorted[i] < limit)
+                {
+                    count++;
+                    i++;
+                }
+                if (count > 0)
+                {
+                    os << "    < " << limit << " ms: " << count << std::endl;
+                }
+                limit *= 2;
+            }
+        }
+    }
+}
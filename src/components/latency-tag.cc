@@ -0,0 +1,81 @@
+#include "ns3/simulator.h"
+#include "include/latency-tag.h"
+
+namespace ns3
+{
+    NS_OBJECT_ENSURE_REGISTERED(LatencyTag);
+
+    TypeId LatencyTag::GetTypeId(void)
+    {
+        static TypeId tid = TypeId("ns3::LatencyTag")
+                                .SetParent<Tag>()
+                                .AddConstructor<LatencyTag>();
+        return tid;
+    }
+
+    TypeId LatencyTag::GetInstanceTypeId(void) const
+    {
+        return LatencyTag::GetTypeId();
+    }
+
+    LatencyTag::LatencyTag()
+    {
+        m_origin = Simulator::Now();
+        m_hops = 0;
+    }
+
+    LatencyTag::LatencyTag(Time origin, uint8_t hops)
+    {
+        m_origin = origin;
+        m_hops = hops;
+    }
+
+    /** Instante de origem em nanossegundos (8 bytes) + contagem de saltos (1 byte)
+     */
+    uint32_t LatencyTag::GetSerializedSize(void) const
+    {
+        return sizeof(int64_t) + sizeof(uint8_t);
+    }
+
+    void LatencyTag::Serialize(TagBuffer i) const
+    {
+        i.WriteU64(m_origin.GetNanoSeconds());
+        i.WriteU8(m_hops);
+    }
+
+    void LatencyTag::Deserialize(TagBuffer i)
+    {
+        m_origin = NanoSeconds(i.ReadU64());
+        m_hops = i.ReadU8();
+    }
+
+    void LatencyTag::Print(std::ostream &os) const
+    {
+        os << "origem: " << m_origin << ", saltos: " << (uint32_t)m_hops;
+    }
+
+    Time LatencyTag::GetOrigin() const
+    {
+        return m_origin;
+    }
+
+    uint8_t LatencyTag::GetHops() const
+    {
+        return m_hops;
+    }
+
+    void LatencyTag::SetOrigin(Time origin)
+    {
+        m_origin = origin;
+    }
+
+    void LatencyTag::SetHops(uint8_t hops)
+    {
+        m_hops = hops;
+    }
+
+    Time LatencyTag::GetElapsed() const
+    {
+        return Simulator::Now() - m_origin;
+    }
+}
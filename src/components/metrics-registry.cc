@@ -0,0 +1,190 @@
+#include "ns3/simulator.h"
+#include "include/metrics-registry.h"
+
+namespace ns3
+{
+    /** Primeira faixa do histograma de tamanho dos quadros, em bytes, e quantidade de faixas (até 4 KiB) */
+    static const double FRAME_BYTES_FIRST_BOUND = 8;
+    static const uint32_t FRAME_BYTES_BUCKETS = 10;
+
+    static void WriteString(std::ostream &os, const std::string &value)
+    {
+        os << '"';
+        for (char c : value)
+        {
+            if (c == '"' || c == '\\')
+            {
+                os << '\\';
+            }
+            os << c;
+        }
+        os << '"';
+    }
+
+    MetricsRegistry::MetricsRegistry()
+    {
+    }
+
+    bool MetricsRegistry::Configure(const std::string &path)
+    {
+        if (m_out.is_open())
+        {
+            m_out.close();
+        }
+        if (path.empty())
+        {
+            return true;
+        }
+        m_out.open(path, std::ios::trunc);
+        return (bool)m_out;
+    }
+
+    bool MetricsRegistry::IsEnabled() const
+    {
+        return m_out.is_open();
+    }
+
+    MetricsRegistry::Node &MetricsRegistry::GetNode(uint32_t node)
+    {
+        std::map<uint32_t, uint32_t>::iterator it = m_nodeIndex.find(node);
+        if (it != m_nodeIndex.end())
+        {
+            return m_nodes[it->second];
+        }
+        Node entry;
+        entry.node = node;
+        m_nodeIndex[node] = m_nodes.size();
+        m_nodes.push_back(entry);
+        return m_nodes.back();
+    }
+
+    uint32_t MetricsRegistry::Add(uint32_t node, const std::string &name, Type type)
+    {
+        Metric metric;
+        metric.name = name;
+        metric.type = type;
+        metric.count = 0;
+        metric.value = 0;
+        metric.firstBound = 0;
+        metric.buckets = 0;
+        metric.offset = 0;
+        m_metrics.push_back(metric);
+        GetNode(node).metrics.push_back(m_metrics.size() - 1);
+        return m_metrics.size() - 1;
+    }
+
+    uint32_t MetricsRegistry::AddCounter(uint32_t node, const std::string &name)
+    {
+        return Add(node, name, COUNTER);
+    }
+
+    uint32_t MetricsRegistry::AddGauge(uint32_t node, const std::string &name)
+    {
+        return Add(node, name, GAUGE);
+    }
+
+    uint32_t MetricsRegistry::AddHistogram(uint32_t node, const std::string &name, double firstBound, uint32_t buckets)
+    {
+        uint32_t id = Add(node, name, HISTOGRAM);
+        m_metrics[id].firstBound = firstBound;
+        m_metrics[id].buckets = buckets > 0 ? buckets : 1;
+        m_metrics[id].offset = m_buckets.size();
+        m_buckets.resize(m_buckets.size() + m_metrics[id].buckets, 0);
+        return id;
+    }
+
+    NodeMetrics MetricsRegistry::AddNode(uint32_t node, const std::string &role)
+    {
+        GetNode(node).role = role;
+
+        NodeMetrics ids;
+        ids.packetsReceived = AddCounter(node, "packets_received");
+        ids.bytesReceived = AddCounter(node, "bytes_received");
+        ids.packetsSent = AddCounter(node, "packets_sent");
+        ids.bytesSent = AddCounter(node, "bytes_sent");
+        ids.invalidFrames = AddCounter(node, "invalid_frames");
+        ids.records = AddCounter(node, "records");
+        for (uint32_t code = 0; code < ERROR_CODES; code++)
+        {
+            ids.errorsSent[code] = AddCounter(node, "errors_sent." + std::to_string(code));
+        }
+        for (uint32_t code = 0; code < ERROR_CODES; code++)
+        {
+            ids.errorsReceived[code] = AddCounter(node, "errors_received." + std::to_string(code));
+        }
+        ids.discrepancies = AddCounter(node, "discrepancies");
+        ids.logExhausted = AddCounter(node, "log_exhausted");
+        ids.frameBytes = AddHistogram(node, "frame_bytes", FRAME_BYTES_FIRST_BOUND, FRAME_BYTES_BUCKETS);
+        return ids;
+    }
+
+    uint64_t MetricsRegistry::GetCount(uint32_t id) const
+    {
+        return m_metrics[id].count;
+    }
+
+    void MetricsRegistry::WriteJson(std::ostream &os) const
+    {
+        os << "{\n  \"time\": " << Simulator::Now().GetSeconds() << ",\n  \"nodes\": [";
+        for (uint32_t n = 0; n < m_nodes.size(); n++)
+        {
+            const Node &node = m_nodes[n];
+            os << (n > 0 ? ",\n" : "\n") << "    {\"node\": " << node.node << ", \"role\": ";
+            WriteString(os, node.role);
+            const char *sections[] = {"counters", "gauges", "histograms"};
+            for (uint32_t type = COUNTER; type <= HISTOGRAM; type++)
+            {
+                os << ", \"" << sections[type] << "\": {";
+                bool first = true;
+                for (uint32_t id : node.metrics)
+                {
+                    const Metric &metric = m_metrics[id];
+                    if (metric.type != type)
+                    {
+                        continue;
+                    }
+                    os << (first ? "" : ", ");
+                    first = false;
+                    WriteString(os, metric.name);
+                    os << ": ";
+                    if (type == COUNTER)
+                    {
+                        os << metric.count;
+                    }
+                    else if (type == GAUGE)
+                    {
+                        os << metric.value;
+                    }
+                    else
+                    {
+                        os << "{\"count\": " << metric.count << ", \"sum\": " << metric.value << ", \"bounds\": [";
+                        double bound = metric.firstBound;
+                        for (uint32_t b = 0; b + 1 < metric.buckets; b++, bound *= 2)
+                        {
+                            os << (b > 0 ? ", " : "") << bound;
+                        }
+                        os << "], \"buckets\": [";
+                        for (uint32_t b = 0; b < metric.buckets; b++)
+                        {
+                            os << (b > 0 ? ", " : "") << m_buckets[metric.offset + b];
+                        }
+                        os << "]}";
+                    }
+                }
+                os << "}";
+            }
+            os << "}";
+        }
+        os << "\n  ]\n}\n";
+    }
+
+    void MetricsRegistry::Dump()
+    {
+        if (!m_out.is_open())
+        {
+            return;
+        }
+        WriteJson(m_out);
+        m_out.close();
+    }
+}
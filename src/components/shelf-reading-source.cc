@@ -0,0 +1,8 @@
+#include "include/shelf-reading-source.h"
+
+namespace ns3
+{
+    ShelfReadingSource::~ShelfReadingSource()
+    {
+    }
+}
@@ -0,0 +1,333 @@
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/inet-socket-address.h"
+#include "include/shelf-sensor-application.h"
+
+namespace ns3
+{
+    NS_LOG_COMPONENT_DEFINE("ShelfSensorApplication");
+    NS_OBJECT_ENSURE_REGISTERED(ShelfSensorApplication);
+
+    SensorReportStats ShelfSensorApplication::s_stats = {0, 0, 0};
+
+    TypeId ShelfSensorApplication::GetTypeId(void)
+    {
+        static TypeId tid = TypeId("ns3::ShelfSensorApplication")
+                                .SetParent<Application>()
+                                .AddConstructor<ShelfSensorApplication>()
+                                .AddAttribute("ShelfId", "Identificador da prateleira no protocolo",
+                                              UintegerValue(1),
+                                              MakeUintegerAccessor(&ShelfSensorApplication::m_shelfId),
+                                              MakeUintegerChecker<uint32_t>(1, NODE_INDEX_MASK))
+                                .AddAttribute("Port", "Porta em que o sensor recebe e envia quadros",
+                                              UintegerValue(5500),
+                                              MakeUintegerAccessor(&ShelfSensorApplication::m_port),
+                                              MakeUintegerChecker<uint16_t>())
+                                .AddAttribute("RelayAddress", "Endereço do nó intermediário entre sensores e servidor",
+                                              Ipv4AddressValue(),
+                                              MakeIpv4AddressAccessor(&ShelfSensorApplication::m_relayAddress),
+                                              MakeIpv4AddressChecker())
+                                .AddAttribute("ReplyJitter", "Atraso máximo, sorteado uniformemente, das respostas a verificações",
+                                              TimeValue(Seconds(0)),
+                                              MakeTimeAccessor(&ShelfSensorApplication::m_replyJitter),
+                                              MakeTimeChecker())
+                                .AddAttribute("DeltaReporting", "Responde a verificações apenas quando o estado da prateleira muda",
+                                              BooleanValue(false),
+                                              MakeBooleanAccessor(&ShelfSensorApplication::m_deltaReporting),
+                                              MakeBooleanChecker())
+                                .AddAttribute("HeartbeatPolls", "Com DeltaReporting, verificações seguidas sem resposta antes de responder como sinal de vida (0 = nunca)",
+                                              UintegerValue(10),
+                                              MakeUintegerAccessor(&ShelfSensorApplication::m_heartbeatPolls),
+                                              MakeUintegerChecker<uint32_t>())
+                                .AddAttribute("Reliable", "Envia as respostas com confirmação e reenvio",
+                                              BooleanValue(false),
+                                              MakeBooleanAccessor(&ShelfSensorApplication::m_reliable),
+                                              MakeBooleanChecker());
+        return tid;
+    }
+
+    TypeId ShelfSensorApplication::GetInstanceTypeId(void) const
+    {
+        return ShelfSensorApplication::GetTypeId();
+    }
+
+    ShelfSensorApplication::ShelfSensorApplication()
+    {
+        m_shelfId = 1;
+        m_port = 5500;
+        m_state = false;
+        m_jitter = CreateObject<UniformRandomVariable>();
+        m_deltaReporting = false;
+        m_heartbeatPolls = 10;
+        m_lastReported = false;
+        m_pollsSinceReport = 0;
+        m_reliable = false;
+        m_metrics = 0;
+        m_log = 0;
+    }
+
+    ShelfSensorApplication::~ShelfSensorApplication()
+    {
+    }
+
+    void ShelfSensorApplication::SetReadingSource(Ptr<ShelfReadingSource> source)
+    {
+        m_source = source;
+    }
+
+    void ShelfSensorApplication::SetInitialState(bool state)
+    {
+        m_state = state;
+        m_lastReported = state; // o servidor começa com o mesmo estado inicial
+    }
+
+    bool ShelfSensorApplication::GetState() const
+    {
+        return m_state;
+    }
+
+    void ShelfSensorApplication::SetEventLog(EventLog *log)
+    {
+        m_log = log;
+    }
+
+    void ShelfSensorApplication::SetMetrics(MetricsRegistry *metrics)
+    {
+        m_metrics = metrics;
+    }
+
+    void ShelfSensorApplication::StartApplication()
+    {
+        NS_LOG_FUNCTION(this);
+        TypeId tid = TypeId::LookupByName("ns3::UdpSocketFactory");
+        m_socket = Socket::CreateSocket(GetNode(), tid);
+        if (m_socket->Bind(InetSocketAddress(Ipv4Address::GetAny(), m_port)) == -1)
+        {
+            NS_FATAL_ERROR("Failed to bind socket");
+        }
+        m_socket->SetRecvCallback(MakeCallback(&ShelfSensorApplication::HandleRead, this));
+        m_socket->SetRecvPktInfo(true);
+        m_writer = FrameWriter(m_socket, m_port, 1); // o sensor só envia para o nó intermediário
+        m_arq = Create<ArqEndpoint>(m_socket, m_port, m_reliable);
+        m_writer.SetArq(m_arq);
+        if (m_metrics)
+        {
+            m_metricIds = m_metrics->AddNode(GetNode()->GetId(), "sensor");
+            m_writer.SetMetrics(m_metrics, m_metricIds);
+        }
+    }
+
+    void ShelfSensorApplication::StopApplication()
+    {
+        NS_LOG_FUNCTION(this);
+        Simulator::Cancel(m_flushEvent);
+        if (m_arq)
+        {
+            m_arq->Close();
+        }
+        if (m_socket)
+        {
+            m_socket->Close();
+            m_socket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
+        }
+    }
+
+    void ShelfSensorApplication::DoDispose()
+    {
+        m_socket = 0;
+        m_source = 0;
+        m_jitter = 0;
+        m_writer = FrameWriter();
+        m_arq = 0;
+        Application::DoDispose();
+    }
+
+    void ShelfSensorApplication::HandleRead(Ptr<Socket> socket)
+    {
+        NS_LOG_FUNCTION(this << socket);
+        Ptr<Packet> packet;
+        Address from;
+        while ((packet = socket->RecvFrom(from)))
+        {
+            uint32_t packetSize = packet->GetSize();
+            Ipv4Address senderAddress = InetSocketAddress::ConvertFrom(from).GetIpv4();
+            if (m_metrics)
+            {
+                m_metrics->OnPacket(m_metricIds, packetSize);
+            }
+            if (m_log)
+            {
+                m_log->LogPacket(GetNode()->GetId(), packetSize);
+            }
+
+            WarehouseFrame frame;
+            if (!ReadFrame(packet, frame)) // quadro com versão desconhecida ou tamanho inconsistente
+            {
+                NS_LOG_INFO("Quadro inválido descartado pelo sensor da prateleira " << m_shelfId << ".");
+                if (m_log)
+                {
+                    m_log->LogInvalidFrame(GetNode()->GetId(), packetSize);
+                }
+                if (m_metrics)
+                {
+                    m_metrics->Increment(m_metricIds.invalidFrames);
+                }
+                continue;
+            }
+            if (!m_arq->Receive(senderAddress, frame.header, packetSize)) // confirmação ou quadro repetido
+            {
+                continue;
+            }
+            LatencyTag origin; // a resposta herda a origem do comando recebido
+            packet->PeekPacketTag(origin);
+            bool urgent = false; // respostas a esvaziar e preencher não são atrasadas
+
+            for (uint16_t r = 0; r < frame.header.recordCount; r++)
+            {
+                const ShelfRecord &data = frame.records[r];
+                if (m_metrics)
+                {
+                    m_metrics->OnRecord(m_metricIds, data);
+                }
+                if (m_log)
+                {
+                    m_log->LogRecord(GetNode()->GetId(), data);
+                }
+                ShelfRecord msg;
+                msg.source = m_shelfId; // A nova mensagem tem como fonte o sensor desta prateleira
+                msg.dest = SERVER_ID; // Identificador do servidor
+                msg.command = data.command; // codigo do comando respondido
+
+                if (data.command != COMMAND_VERIFY && data.command != COMMAND_EMPTY && data.command != COMMAND_FILL)
+                {
+                    // Inconsistência na mensagem(Não deve entrar aqui)
+                    NS_LOG_INFO("O sensor não consegue processar o comando enviado.");
+                    continue;
+                }
+                switch (data.command)
+                {
+                case COMMAND_VERIFY: // Verificar estado do sensor
+                    if (!HasReadings())
+                    {
+                        continue;
+                    }
+                    m_state = m_source->Next(); // Lê do log das leituras do sensor o próximo valor
+                    if (m_deltaReporting && m_state == m_lastReported)
+                    {
+                        // compara antes de contar: exatamente HeartbeatPolls verificações ficam sem resposta
+                        if (m_heartbeatPolls == 0 || m_pollsSinceReport < m_heartbeatPolls)
+                        {
+                            m_pollsSinceReport++;
+                            s_stats.suppressed++; // estado inalterado: o silêncio basta para o servidor
+                            continue;
+                        }
+                        s_stats.heartbeats++;
+                    }
+                    break;
+                case COMMAND_EMPTY: // Esvaziar prateleira
+                    if (!HasReadings())
+                    {
+                        continue;
+                    }
+                    m_state = false;
+                    urgent = true;
+                    break;
+                case COMMAND_FILL: // Preencher prateleira
+                    m_state = true;
+                    urgent = true;
+                    break;
+                }
+                msg.payload = m_state; // Payload assume o estado atual da prateleira
+                m_writer.Append(m_relayAddress, msg, origin);
+                if (m_log)
+                {
+                    m_log->LogSentRecord(GetNode()->GetId(), msg);
+                }
+                m_lastReported = m_state;
+                m_pollsSinceReport = 0;
+                s_stats.sent++;
+
+                NS_LOG_LOGIC("src: " << data.source << ", dest: " << data.dest << ", command: " << (uint32_t)data.command << ", payload: " << data.payload);
+            }
+            if (urgent || m_replyJitter.IsZero())
+            {
+                Simulator::Cancel(m_flushEvent);
+                m_writer.Flush(); // envia o quadro com as respostas para o nó intermediário
+            }
+            else if (!m_flushEvent.IsRunning())
+            {
+                m_flushEvent = Simulator::Schedule(Seconds(m_jitter->GetValue(0, m_replyJitter.GetSeconds())),
+                                                   &ShelfSensorApplication::FlushReplies, this);
+            }
+
+            NS_LOG_INFO("Sensor " << m_shelfId << " recebeu pacote de " << senderAddress << ", tamanho: " << packetSize << " bytes");
+        }
+    }
+
+    void ShelfSensorApplication::FlushReplies()
+    {
+        m_writer.Flush();
+    }
+
+    bool ShelfSensorApplication::HasReadings()
+    {
+        if (m_source && m_source->HasNext())
+        {
+            return true;
+        }
+        // caso o log esteja vazio, avisa que não há mais leituras do sensor
+        NS_LOG_INFO("Log esvaziado. Não Há mais leituras do sensor da prateleira " << m_shelfId << ".");
+        if (m_metrics)
+        {
+            m_metrics->Increment(m_metricIds.logExhausted);
+        }
+        return false;
+    }
+
+    const SensorReportStats &ShelfSensorApplication::GetStats()
+    {
+        return s_stats;
+    }
+
+    uint32_t ShelfSensorApplication::GetMemoryUsage() const
+    {
+        return sizeof(*this) + m_writer.GetMemoryUsage() + (m_arq ? m_arq->GetMemoryUsage() : 0);
+    }
+
+    ShelfSensorHelper::ShelfSensorHelper(Ipv4Address relayAddress, uint16_t port)
+    {
+        m_factory.SetTypeId(ShelfSensorApplication::GetTypeId());
+        m_factory.Set("RelayAddress", Ipv4AddressValue(relayAddress));
+        m_factory.Set("Port", UintegerValue(port));
+    }
+
+    void ShelfSensorHelper::SetAttribute(std::string name, const AttributeValue &value)
+    {
+        m_factory.Set(name, value);
+    }
+
+    ApplicationContainer ShelfSensorHelper::Install(NodeContainer nodes, const std::vector<Ptr<ShelfReadingSource>> &sources,
+                                                    const ShelfStateTable &initialStates, uint32_t firstShelfId) const
+    {
+        ApplicationContainer apps;
+        for (uint32_t i = 0; i < nodes.GetN(); i++)
+        {
+            Ptr<ShelfSensorApplication> app = m_factory.Create<ShelfSensorApplication>();
+            app->SetAttribute("ShelfId", UintegerValue(firstShelfId + i));
+            if (i < sources.size())
+            {
+                app->SetReadingSource(sources[i]);
+            }
+            if (i < initialStates.GetSize())
+            {
+                app->SetInitialState(initialStates.Get(i));
+            }
+            nodes.Get(i)->AddApplication(app);
+            apps.Add(app);
+        }
+        return apps;
+    }
+}
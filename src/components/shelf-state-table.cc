@@ -0,0 +1,209 @@
+#include "include/shelf-state-table.h"
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace ns3
+{
+    ShelfStateTable::ShelfStateTable()
+    {
+        m_size = 0;
+        m_stagedCount = 0;
+        m_dirtyBegin = 0;
+        m_dirtyEnd = 0;
+    }
+
+    ShelfStateTable::ShelfStateTable(uint32_t size)
+    {
+        Resize(size);
+    }
+
+    void ShelfStateTable::Resize(uint32_t size)
+    {
+        uint32_t blocks = (size + 64 * WORDS_PER_BLOCK - 1) / (64 * WORDS_PER_BLOCK);
+        m_size = size;
+        m_state.resize(blocks * WORDS_PER_BLOCK, 0);
+        // bits além do novo tamanho são zerados para que CountFull e as comparações não os contem
+        if (size % 64 != 0)
+        {
+            m_state[size / 64] &= (uint64_t(1) << (size % 64)) - 1;
+        }
+        for (uint32_t w = (size + 63) / 64; w < m_state.size(); w++)
+        {
+            m_state[w] = 0;
+        }
+        m_reported.assign(m_state.size(), 0);
+        m_staged.assign(m_state.size(), 0);
+        m_stagedCount = 0;
+        m_dirtyBegin = 0;
+        m_dirtyEnd = 0;
+    }
+
+    uint32_t ShelfStateTable::GetSize() const
+    {
+        return m_size;
+    }
+
+    bool ShelfStateTable::Get(uint32_t shelf) const
+    {
+        return (m_state[shelf / 64] >> (shelf % 64)) & 1;
+    }
+
+    void ShelfStateTable::Set(uint32_t shelf, bool full)
+    {
+        uint64_t bit = uint64_t(1) << (shelf % 64);
+        if (full)
+        {
+            m_state[shelf / 64] |= bit;
+        }
+        else
+        {
+            m_state[shelf / 64] &= ~bit;
+        }
+    }
+
+    uint32_t ShelfStateTable::CountFull() const
+    {
+        uint32_t count = 0;
+        for (uint32_t w = 0; w < m_state.size(); w++)
+        {
+            count += __builtin_popcountll(m_state[w]);
+        }
+        return count;
+    }
+
+    bool ShelfStateTable::Stage(uint32_t shelf, bool reported)
+    {
+        uint32_t word = shelf / 64;
+        uint64_t bit = uint64_t(1) << (shelf % 64);
+        if (m_staged[word] & bit) // já há um relato pendente desta prateleira
+        {
+            return false;
+        }
+        m_staged[word] |= bit;
+        if (reported)
+        {
+            m_reported[word] |= bit;
+        }
+
+        uint32_t block = word / WORDS_PER_BLOCK;
+        if (m_stagedCount == 0)
+        {
+            m_dirtyBegin = block;
+            m_dirtyEnd = block + 1;
+        }
+        else
+        {
+            m_dirtyBegin = block < m_dirtyBegin ? block : m_dirtyBegin;
+            m_dirtyEnd = block + 1 > m_dirtyEnd ? block + 1 : m_dirtyEnd;
+        }
+        m_stagedCount++;
+        return true;
+    }
+
+    uint32_t ShelfStateTable::GetStagedCount() const
+    {
+        return m_stagedCount;
+    }
+
+    uint32_t ShelfStateTable::CollectBits(uint64_t word, uint32_t base, std::vector<uint32_t> &out)
+    {
+        uint32_t count = __builtin_popcountll(word);
+        while (word)
+        {
+            out.push_back(base + __builtin_ctzll(word));
+            word &= word - 1; // remove o bit menos significativo
+        }
+        return count;
+    }
+
+    /** Só os blocos entre o primeiro e o último relato pendente são percorridos. Em cada palavra,
+     * diff = (estado ^ relatado) & pendentes marca as discrepâncias; estado ^= diff aplica os relatos.
+     */
+    uint32_t ShelfStateTable::ApplyStaged(std::vector<uint32_t> &discrepancies)
+    {
+        uint32_t count = 0;
+        if (m_stagedCount == 0)
+        {
+            return 0;
+        }
+
+        for (uint32_t b = m_dirtyBegin; b < m_dirtyEnd; b++)
+        {
+            uint32_t w = b * WORDS_PER_BLOCK;
+            uint64_t diff[WORDS_PER_BLOCK];
+#ifdef __AVX2__
+            __m256i staged = _mm256_loadu_si256((const __m256i *) &m_staged[w]);
+            if (_mm256_testz_si256(staged, staged)) // bloco sem relatos
+            {
+                continue;
+            }
+            __m256i state = _mm256_loadu_si256((const __m256i *) &m_state[w]);
+            __m256i reported = _mm256_loadu_si256((const __m256i *) &m_reported[w]);
+            __m256i d = _mm256_and_si256(_mm256_xor_si256(state, reported), staged);
+            _mm256_storeu_si256((__m256i *) &m_state[w], _mm256_xor_si256(state, d));
+            _mm256_storeu_si256((__m256i *) &m_reported[w], _mm256_setzero_si256());
+            _mm256_storeu_si256((__m256i *) &m_staged[w], _mm256_setzero_si256());
+            _mm256_storeu_si256((__m256i *) diff, d);
+#else
+            for (uint32_t i = 0; i < WORDS_PER_BLOCK; i++)
+            {
+                diff[i] = (m_state[w + i] ^ m_reported[w + i]) & m_staged[w + i];
+                m_state[w + i] ^= diff[i];
+                m_reported[w + i] = 0;
+                m_staged[w + i] = 0;
+            }
+#endif
+            for (uint32_t i = 0; i < WORDS_PER_BLOCK; i++)
+            {
+                if (diff[i])
+                {
+                    count += CollectBits(diff[i], (w + i) * 64, discrepancies);
+                }
+            }
+        }
+
+        m_stagedCount = 0;
+        m_dirtyBegin = 0;
+        m_dirtyEnd = 0;
+        return count;
+    }
+
+    uint32_t ShelfStateTable::Compare(const ShelfStateTable &a, const ShelfStateTable &b, std::vector<uint32_t> &discrepancies)
+    {
+        uint32_t count = 0;
+        uint32_t words = a.m_state.size() < b.m_state.size() ? a.m_state.size() : b.m_state.size();
+
+        for (uint32_t w = 0; w < words; w += WORDS_PER_BLOCK)
+        {
+            uint64_t diff[WORDS_PER_BLOCK];
+#ifdef __AVX2__
+            __m256i d = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *) &a.m_state[w]),
+                                         _mm256_loadu_si256((const __m256i *) &b.m_state[w]));
+            if (_mm256_testz_si256(d, d)) // bloco idêntico
+            {
+                continue;
+            }
+            _mm256_storeu_si256((__m256i *) diff, d);
+#else
+            for (uint32_t i = 0; i < WORDS_PER_BLOCK; i++)
+            {
+                diff[i] = a.m_state[w + i] ^ b.m_state[w + i];
+            }
+#endif
+            for (uint32_t i = 0; i < WORDS_PER_BLOCK; i++)
+            {
+                if (diff[i])
+                {
+                    count += CollectBits(diff[i], (w + i) * 64, discrepancies);
+                }
+            }
+        }
+        return count;
+    }
+
+    uint32_t ShelfStateTable::GetMemoryUsage() const
+    {
+        return sizeof(*this) + (m_state.capacity() + m_reported.capacity() + m_staged.capacity()) * sizeof(uint64_t);
+    }
+}
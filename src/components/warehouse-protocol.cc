@@ -0,0 +1,186 @@
+#include "include/warehouse-protocol.h"
+
+namespace ns3
+{
+    static uint32_t GetVarintSize(uint32_t value)
+    {
+        uint32_t size = 1;
+        while (value >= 0x80)
+        {
+            value >>= 7;
+            size++;
+        }
+        return size;
+    }
+
+    static uint32_t WriteVarint(uint32_t value, uint8_t *buffer)
+    {
+        uint32_t size = 0;
+        while (value >= 0x80)
+        {
+            buffer[size++] = (value & 0x7f) | 0x80;
+            value >>= 7;
+        }
+        buffer[size++] = value;
+        return size;
+    }
+
+    /** \brief Lê um varint de no máximo 5 bytes entre cursor e end. Retorna false se o varint
+     * passar de end ou não couber em 32 bits.
+     */
+    static bool ReadVarint(const uint8_t *&cursor, const uint8_t *end, uint32_t &value)
+    {
+        uint64_t result = 0;
+        for (uint32_t shift = 0; shift < 35; shift += 7)
+        {
+            if (cursor == end)
+            {
+                return false;
+            }
+            uint8_t byte = *cursor++;
+            result |= (uint64_t)(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+            {
+                value = result;
+                return result <= 0xffffffff;
+            }
+        }
+        return false;
+    }
+
+    /** Na transmissão o papel vai nos 2 bits mais baixos, para que o varint dos índices baixos ocupe um byte */
+    static uint32_t GetWireNodeId(uint32_t id)
+    {
+        return (GetNodeIndex(id) << 2) | GetNodeRole(id);
+    }
+
+    static uint32_t GetNodeIdFromWire(uint32_t wire)
+    {
+        return MakeNodeId(wire & 3, wire >> 2);
+    }
+
+    uint32_t GetNodeIdSize(uint32_t id)
+    {
+        return GetVarintSize(GetWireNodeId(id));
+    }
+
+    uint32_t GetRecordSize(const ShelfRecord &record)
+    {
+        return GetNodeIdSize(record.source) + GetNodeIdSize(record.dest) + 1 + GetVarintSize(record.payload);
+    }
+
+    void EncodeFrameHeader(const FrameHeader &header, uint8_t *buffer)
+    {
+        buffer[0] = WAREHOUSE_PROTOCOL_VERSION;
+        buffer[1] = header.flags;
+        buffer[2] = header.sequence >> 8;
+        buffer[3] = header.sequence & 0xff;
+        buffer[4] = header.recordCount >> 8;
+        buffer[5] = header.recordCount & 0xff;
+    }
+
+    uint32_t EncodeRecord(const ShelfRecord &record, uint8_t *buffer)
+    {
+        uint32_t size = WriteVarint(GetWireNodeId(record.source), buffer);
+        size += WriteVarint(GetWireNodeId(record.dest), buffer + size);
+        buffer[size++] = record.command;
+        size += WriteVarint(record.payload, buffer + size);
+        return size;
+    }
+
+    uint32_t EncodeFrame(const WarehouseFrame &frame, uint8_t *buffer, uint32_t capacity)
+    {
+        uint32_t count = frame.header.recordCount;
+        if (count > MAX_RECORDS_PER_FRAME)
+        {
+            return 0;
+        }
+        uint32_t size = FRAME_HEADER_SIZE;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            size += GetRecordSize(frame.records[i]);
+        }
+        if (size > capacity)
+        {
+            return 0;
+        }
+
+        EncodeFrameHeader(frame.header, buffer);
+        uint8_t *cursor = buffer + FRAME_HEADER_SIZE;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            cursor += EncodeRecord(frame.records[i], cursor);
+        }
+        return size;
+    }
+
+    bool DecodeFrame(const uint8_t *buffer, uint32_t size, WarehouseFrame &frame)
+    {
+        if (size < FRAME_HEADER_SIZE || buffer[0] != WAREHOUSE_PROTOCOL_VERSION)
+        {
+            return false;
+        }
+
+        frame.header.version = buffer[0];
+        frame.header.flags = buffer[1];
+        frame.header.sequence = (buffer[2] << 8) | buffer[3];
+        frame.header.recordCount = (buffer[4] << 8) | buffer[5];
+        if (frame.header.recordCount > MAX_RECORDS_PER_FRAME
+            || size < FRAME_HEADER_SIZE + frame.header.recordCount * MIN_RECORD_SIZE)
+        {
+            return false;
+        }
+
+        const uint8_t *cursor = buffer + FRAME_HEADER_SIZE;
+        const uint8_t *end = buffer + size;
+        for (uint32_t i = 0; i < frame.header.recordCount; i++)
+        {
+            ShelfRecord &record = frame.records[i];
+            uint32_t source;
+            uint32_t dest;
+            if (!ReadVarint(cursor, end, source) || !ReadVarint(cursor, end, dest) || cursor == end)
+            {
+                return false;
+            }
+            record.source = GetNodeIdFromWire(source);
+            record.dest = GetNodeIdFromWire(dest);
+            record.command = *cursor++;
+            if (!ReadVarint(cursor, end, record.payload))
+            {
+                return false;
+            }
+        }
+        return cursor == end;
+    }
+
+    uint64_t GetAirBytes(const WireStats &stats)
+    {
+        return stats.payloadBytes + stats.datagrams * DATAGRAM_OVERHEAD;
+    }
+
+    uint64_t GetLegacyAirBytes(const WireStats &stats)
+    {
+        return stats.records * (LEGACY_RECORD_SIZE + DATAGRAM_OVERHEAD);
+    }
+
+    const char *GetCommandName(uint8_t command)
+    {
+        switch (command)
+        {
+        case COMMAND_VERIFY:
+            return "verificar";
+        case COMMAND_EMPTY:
+            return "esvaziar";
+        case COMMAND_FILL:
+            return "preencher";
+        case COMMAND_REPORT:
+            return "relatório";
+        case COMMAND_REPORT_MISSING:
+            return "ausentes";
+        case COMMAND_ERROR:
+            return "erro";
+        default:
+            return "desconhecido";
+        }
+    }
+}
@@ -0,0 +1,462 @@
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/enum.h"
+#include "ns3/inet-socket-address.h"
+#include "include/warehouse-relay-application.h"
+#include <algorithm>
+
+namespace ns3
+{
+    NS_LOG_COMPONENT_DEFINE("WarehouseRelayApplication");
+    NS_OBJECT_ENSURE_REGISTERED(WarehouseRelayApplication);
+
+    TypeId WarehouseRelayApplication::GetTypeId(void)
+    {
+        static TypeId tid = TypeId("ns3::WarehouseRelayApplication")
+                                .SetParent<Application>()
+                                .AddConstructor<WarehouseRelayApplication>()
+                                .AddAttribute("NodeId", "Identificador do intermediário no protocolo",
+                                              UintegerValue(SENSOR_RELAY_ID),
+                                              MakeUintegerAccessor(&WarehouseRelayApplication::m_nodeId),
+                                              MakeUintegerChecker<uint32_t>())
+                                .AddAttribute("UplinkId", "Identificador do nó acima do intermediário",
+                                              UintegerValue(SERVER_ID),
+                                              MakeUintegerAccessor(&WarehouseRelayApplication::m_uplinkId),
+                                              MakeUintegerChecker<uint32_t>())
+                                .AddAttribute("UplinkAddress", "Endereço do nó acima do intermediário",
+                                              Ipv4AddressValue(),
+                                              MakeIpv4AddressAccessor(&WarehouseRelayApplication::m_uplinkAddress),
+                                              MakeIpv4AddressChecker())
+                                .AddAttribute("ShardBy", "Campo dos registros vindos de baixo que identifica a prateleira, para a escolha do servidor dono",
+                                              EnumValue(WarehouseRelayApplication::SHARD_BY_SOURCE),
+                                              MakeEnumAccessor(&WarehouseRelayApplication::m_shardKey),
+                                              MakeEnumChecker(WarehouseRelayApplication::SHARD_BY_SOURCE, "Source",
+                                                              WarehouseRelayApplication::SHARD_BY_PAYLOAD, "Payload"))
+                                .AddAttribute("Port", "Porta em que o intermediário recebe e envia quadros",
+                                              UintegerValue(5500),
+                                              MakeUintegerAccessor(&WarehouseRelayApplication::m_port),
+                                              MakeUintegerChecker<uint16_t>())
+                                .AddAttribute("AggregationWindow", "Tempo máximo de espera pelas respostas a uma verificação antes de enviar o relatório agregado; zero desativa a agregação",
+                                              TimeValue(Seconds(0)),
+                                              MakeTimeAccessor(&WarehouseRelayApplication::m_aggregationWindow),
+                                              MakeTimeChecker())
+                                .AddAttribute("Reliable", "Envia os quadros unicast com confirmação e reenvio",
+                                              BooleanValue(false),
+                                              MakeBooleanAccessor(&WarehouseRelayApplication::m_reliable),
+                                              MakeBooleanChecker());
+        return tid;
+    }
+
+    TypeId WarehouseRelayApplication::GetInstanceTypeId(void) const
+    {
+        return WarehouseRelayApplication::GetTypeId();
+    }
+
+    WarehouseRelayApplication::WarehouseRelayApplication()
+    {
+        m_nodeId = SENSOR_RELAY_ID;
+        m_uplinkId = SERVER_ID;
+        m_shardKey = SHARD_BY_SOURCE;
+        m_port = 5500;
+        m_log = 0;
+        m_metrics = 0;
+        m_roundOpen = false;
+        m_roundPending = 0;
+        m_expectedCount = 0;
+        m_reliable = false;
+        m_defaultHandler = MakeCallback(&WarehouseRelayApplication::RejectCommand, this);
+    }
+
+    WarehouseRelayApplication::~WarehouseRelayApplication()
+    {
+    }
+
+    /** Os próximos saltos são guardados sem repetição, para que ForwardToAll envie uma cópia por salto.
+     * A busca linear só acontece na configuração.
+     */
+    void WarehouseRelayApplication::AddRoute(uint32_t nodeId, Ipv4Address nextHop)
+    {
+        uint32_t index = m_nextHops.size();
+        for (uint32_t i = 0; i < m_nextHops.size(); i++)
+        {
+            if (m_nextHops[i] == nextHop)
+            {
+                index = i;
+                break;
+            }
+        }
+        if (index == m_nextHops.size())
+        {
+            m_nextHops.push_back(nextHop);
+        }
+        std::vector<uint32_t> &routes = m_routes[GetNodeRole(nodeId)];
+        uint32_t nodeIndex = GetNodeIndex(nodeId);
+        if (nodeIndex >= routes.size())
+        {
+            routes.resize(nodeIndex + 1, NO_ROUTE);
+        }
+        routes[nodeIndex] = index;
+    }
+
+    uint32_t WarehouseRelayApplication::GetRoute(uint32_t id) const
+    {
+        const std::vector<uint32_t> &routes = m_routes[GetNodeRole(id)];
+        uint32_t index = GetNodeIndex(id);
+        return index < routes.size() ? routes[index] : NO_ROUTE;
+    }
+
+    void WarehouseRelayApplication::AddShard(uint32_t firstId, uint32_t lastId, Ipv4Address uplink)
+    {
+        uint32_t index = std::find(m_uplinks.begin(), m_uplinks.end(), uplink) - m_uplinks.begin();
+        if (index == m_uplinks.size())
+        {
+            m_uplinks.push_back(uplink);
+        }
+        if (lastId >= m_shardRoutes.size())
+        {
+            m_shardRoutes.resize(lastId + 1, NO_ROUTE);
+        }
+        std::fill(m_shardRoutes.begin() + firstId, m_shardRoutes.begin() + lastId + 1, index);
+    }
+
+    uint32_t WarehouseRelayApplication::GetShardShelf(const ShelfRecord &record) const
+    {
+        if (record.command == COMMAND_REPORT || record.command == COMMAND_REPORT_MISSING) // relatório de um intermediário abaixo: dest é o grupo
+        {
+            return record.dest * 8 + 1;
+        }
+        return m_shardKey == SHARD_BY_PAYLOAD ? record.payload : record.source;
+    }
+
+    Ipv4Address WarehouseRelayApplication::GetUplink(uint32_t id) const
+    {
+        if (id >= m_shardRoutes.size() || m_shardRoutes[id] == NO_ROUTE)
+        {
+            return m_uplinkAddress;
+        }
+        return m_uplinks[m_shardRoutes[id]];
+    }
+
+    void WarehouseRelayApplication::SetCommandHandler(uint8_t command, RecordHandler handler)
+    {
+        m_handlers[command] = handler;
+    }
+
+    void WarehouseRelayApplication::SetDefaultHandler(RecordHandler handler)
+    {
+        m_defaultHandler = handler;
+    }
+
+    void WarehouseRelayApplication::SetEventLog(EventLog *log)
+    {
+        m_log = log;
+    }
+
+    void WarehouseRelayApplication::SetMetrics(MetricsRegistry *metrics)
+    {
+        m_metrics = metrics;
+    }
+
+    void WarehouseRelayApplication::ForwardToDest(const ShelfRecord &record, Ipv4Address sender)
+    {
+        uint32_t route = GetRoute(record.dest);
+        if (route == NO_ROUTE) // destino não é um nó abaixo deste intermediário
+        {
+            SendError(sender, record.source, ERROR_INVALID_DEST);
+            return;
+        }
+        Forward(m_nextHops[route], record);
+    }
+
+    void WarehouseRelayApplication::ForwardToAll(const ShelfRecord &record, Ipv4Address)
+    {
+        for (uint32_t i = 0; i < m_nextHops.size(); i++)
+        {
+            Forward(m_nextHops[i], record);
+        }
+    }
+
+    void WarehouseRelayApplication::Broadcast(const ShelfRecord &record, Ipv4Address)
+    {
+        if (m_broadcasts.empty())
+        {
+            Forward(Ipv4Address::GetBroadcast(), record);
+            return;
+        }
+        for (uint32_t i = 0; i < m_broadcasts.size(); i++)
+        {
+            Forward(m_broadcasts[i], record);
+        }
+    }
+
+    void WarehouseRelayApplication::AddBroadcastAddress(Ipv4Address address)
+    {
+        m_broadcasts.push_back(address);
+    }
+
+    void WarehouseRelayApplication::Drop(const ShelfRecord &, Ipv4Address)
+    {
+    }
+
+    void WarehouseRelayApplication::RejectCommand(const ShelfRecord &record, Ipv4Address sender)
+    {
+        SendError(sender, record.source, ERROR_INVALID_COMMAND);
+    }
+
+    void WarehouseRelayApplication::Forward(Ipv4Address nextHop, const ShelfRecord &record)
+    {
+        m_writer.Append(nextHop, record, m_origin);
+    }
+
+    void WarehouseRelayApplication::SendError(Ipv4Address to, uint32_t dest, uint8_t code)
+    {
+        ShelfRecord errorMsg;
+        errorMsg.source = m_nodeId; // quem manda é este intermediário
+        errorMsg.dest = dest; // endereço de quem enviou a mensagem
+        errorMsg.command = COMMAND_ERROR; // codigo de mensagem de erro
+        errorMsg.payload = code;
+        m_writer.Append(to, errorMsg, m_origin);
+        if (m_metrics && code < ERROR_CODES)
+        {
+            m_metrics->Increment(m_metricIds.errorsSent[code]);
+        }
+    }
+
+    void WarehouseRelayApplication::StartApplication()
+    {
+        NS_LOG_FUNCTION(this);
+        TypeId tid = TypeId::LookupByName("ns3::UdpSocketFactory");
+        m_socket = Socket::CreateSocket(GetNode(), tid);
+        if (m_socket->Bind(InetSocketAddress(Ipv4Address::GetAny(), m_port)) == -1)
+        {
+            NS_FATAL_ERROR("Failed to bind socket");
+        }
+        m_socket->SetRecvCallback(MakeCallback(&WarehouseRelayApplication::HandleRead, this));
+        m_socket->SetRecvPktInfo(true);
+        m_socket->SetAllowBroadcast(true);
+        m_writer = FrameWriter(m_socket, m_port);
+        m_arq = Create<ArqEndpoint>(m_socket, m_port, m_reliable);
+        m_writer.SetArq(m_arq);
+        for (uint32_t i = 0; i < m_broadcasts.size(); i++)
+        {
+            m_writer.AddBroadcastAddress(m_broadcasts[i]);
+        }
+        if (m_metrics)
+        {
+            m_metricIds = m_metrics->AddNode(GetNode()->GetId(), m_nodeId == GATEWAY_RELAY_ID ? "gateway_relay" : m_nodeId == SENSOR_RELAY_ID ? "sensor_relay" : "aisle_relay");
+            m_writer.SetMetrics(m_metrics, m_metricIds);
+        }
+
+        // prateleiras esperadas em cada rodada de agregação: todas com rota, identificador i no bit (i - 1) % 8 do grupo (i - 1) / 8
+        const std::vector<uint32_t> &shelves = m_routes[ROLE_SHELF];
+        uint32_t groups = shelves.size() / 8 + 1;
+        m_expected.assign(groups, 0);
+        m_replied.assign(groups, 0);
+        m_states.assign(groups, 0);
+        m_expectedCount = 0;
+        for (uint32_t id = 1; id < shelves.size(); id++)
+        {
+            if (shelves[id] != NO_ROUTE)
+            {
+                m_expected[(id - 1) / 8] |= 1 << ((id - 1) % 8);
+                m_expectedCount++;
+            }
+        }
+    }
+
+    void WarehouseRelayApplication::StopApplication()
+    {
+        NS_LOG_FUNCTION(this);
+        Simulator::Cancel(m_roundEvent);
+        m_roundOpen = false;
+        if (m_arq)
+        {
+            m_arq->Close();
+        }
+        if (m_socket)
+        {
+            m_socket->Close();
+            m_socket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
+        }
+    }
+
+    void WarehouseRelayApplication::DoDispose()
+    {
+        m_socket = 0;
+        m_writer = FrameWriter();
+        m_arq = 0;
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            m_handlers[i] = RecordHandler();
+        }
+        m_defaultHandler = RecordHandler();
+        Application::DoDispose();
+    }
+
+    void WarehouseRelayApplication::HandleRead(Ptr<Socket> socket)
+    {
+        NS_LOG_FUNCTION(this << socket);
+        Ptr<Packet> packet;
+        Address from;
+        while ((packet = socket->RecvFrom(from)))
+        {
+            uint32_t packetSize = packet->GetSize();
+            Ipv4Address senderAddress = InetSocketAddress::ConvertFrom(from).GetIpv4();
+            if (m_log)
+            {
+                m_log->LogPacket(GetNode()->GetId(), packetSize);
+            }
+            if (m_metrics)
+            {
+                m_metrics->OnPacket(m_metricIds, packetSize);
+            }
+
+            WarehouseFrame frame;
+            if (!ReadFrame(packet, frame)) // quadro com versão desconhecida ou tamanho inconsistente
+            {
+                NS_LOG_INFO("Quadro inválido descartado pelo intermediário " << m_nodeId << ".");
+                if (m_log)
+                {
+                    m_log->LogInvalidFrame(GetNode()->GetId(), packetSize);
+                }
+                if (m_metrics)
+                {
+                    m_metrics->Increment(m_metricIds.invalidFrames);
+                }
+                continue;
+            }
+            if (frame.header.flags & FRAME_FLAG_BROADCAST) // difusão destinada aos sensores, inclusive a enviada por este nó
+            {
+                continue;
+            }
+            if (!m_arq->Receive(senderAddress, frame.header, packetSize)) // confirmação ou quadro repetido
+            {
+                continue;
+            }
+            m_origin = LatencyTag(); // registros gerados a partir deste quadro herdam a origem do comando
+            packet->PeekPacketTag(m_origin);
+
+            for (uint16_t r = 0; r < frame.header.recordCount; r++)
+            {
+                const ShelfRecord &data = frame.records[r];
+                if (data.source == m_uplinkId) // Veio do uplink: o comando decide o que fazer
+                {
+                    if (data.command == COMMAND_VERIFY && !m_aggregationWindow.IsZero())
+                    {
+                        OpenRound();
+                    }
+                    const RecordHandler &handler = m_handlers[data.command];
+                    if (handler.IsNull())
+                    {
+                        m_defaultHandler(data, senderAddress);
+                    }
+                    else
+                    {
+                        handler(data, senderAddress);
+                    }
+                }
+                else if (GetRoute(data.source) != NO_ROUTE) // Veio de um nó abaixo: repassa ao uplink
+                {
+                    if (!Aggregate(data)) // fora de uma rodada de agregação
+                    {
+                        Forward(GetUplink(GetShardShelf(data)), data);
+                    }
+                }
+                else // Inconsistência na mensagem
+                {
+                    SendError(senderAddress, data.source, ERROR_INVALID_SOURCE);
+                }
+
+                if (m_log)
+                {
+                    m_log->LogRecord(GetNode()->GetId(), data);
+                }
+                if (m_metrics)
+                {
+                    m_metrics->OnRecord(m_metricIds, data);
+                }
+            }
+            m_writer.Flush(); // envia um quadro para cada próximo salto com os registros processados
+        }
+    }
+
+    void WarehouseRelayApplication::OpenRound()
+    {
+        if (m_roundOpen) // a verificação anterior não terminou: envia o que foi recebido dela
+        {
+            CloseRound();
+        }
+        m_roundOpen = true;
+        m_roundOrigin = m_origin;
+        m_roundPending = m_expectedCount;
+        std::fill(m_replied.begin(), m_replied.end(), 0);
+        std::fill(m_states.begin(), m_states.end(), 0);
+        m_roundEvent = Simulator::Schedule(m_aggregationWindow, &WarehouseRelayApplication::RoundTimeout, this);
+    }
+
+    bool WarehouseRelayApplication::Aggregate(const ShelfRecord &record)
+    {
+        if (!m_roundOpen || record.command != COMMAND_VERIFY || GetNodeRole(record.source) != ROLE_SHELF || m_origin.GetOrigin() != m_roundOrigin.GetOrigin())
+        {
+            return false;
+        }
+        uint32_t group = (record.source - 1) / 8;
+        uint8_t bit = 1 << ((record.source - 1) % 8);
+        if (!(m_replied[group] & bit)) // respostas repetidas na mesma rodada valem uma vez
+        {
+            m_replied[group] |= bit;
+            m_states[group] |= record.payload ? bit : 0;
+            m_roundPending--;
+        }
+        if (m_roundPending == 0) // todos responderam, não é preciso esperar a janela
+        {
+            CloseRound();
+        }
+        return true;
+    }
+
+    void WarehouseRelayApplication::CloseRound()
+    {
+        Simulator::Cancel(m_roundEvent);
+        m_roundOpen = false;
+        LatencyTag current = m_origin;
+        m_origin = m_roundOrigin; // o relatório herda a origem da verificação
+        for (uint32_t group = 0; group < m_expected.size(); group++)
+        {
+            uint8_t missing = m_expected[group] & ~m_replied[group];
+            Ipv4Address uplink = GetUplink(group * 8 + 1); // os servidores são donos de grupos inteiros
+            if (missing)
+            {
+                ShelfRecord report = {m_nodeId, group, COMMAND_REPORT_MISSING, missing};
+                Forward(uplink, report);
+            }
+            if (m_replied[group])
+            {
+                ShelfRecord report = {m_nodeId, group, COMMAND_REPORT, m_states[group]};
+                Forward(uplink, report);
+            }
+        }
+        m_origin = current;
+    }
+
+    void WarehouseRelayApplication::RoundTimeout()
+    {
+        CloseRound();
+        m_writer.Flush();
+    }
+
+    uint32_t WarehouseRelayApplication::GetMemoryUsage() const
+    {
+        uint32_t routes = 0;
+        for (uint32_t role = 0; role < NODE_ROLES; role++)
+        {
+            routes += m_routes[role].capacity();
+        }
+        return sizeof(*this) + routes * sizeof(uint32_t) + m_nextHops.capacity() * sizeof(Ipv4Address)
+               + m_shardRoutes.capacity() * sizeof(uint32_t) + m_uplinks.capacity() * sizeof(Ipv4Address)
+               + (m_expected.capacity() + m_replied.capacity() + m_states.capacity()) + m_writer.GetMemoryUsage()
+               + (m_arq ? m_arq->GetMemoryUsage() : 0);
+    }
+}
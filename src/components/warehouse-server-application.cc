@@ -0,0 +1,515 @@
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/inet-socket-address.h"
+#include "include/warehouse-server-application.h"
+#include <algorithm>
+
+namespace ns3
+{
+    NS_LOG_COMPONENT_DEFINE("WarehouseServerApplication");
+    NS_OBJECT_ENSURE_REGISTERED(WarehouseServerApplication);
+
+    ServerBatchStats WarehouseServerApplication::s_stats = {0, 0, 0, 0};
+
+    TypeId WarehouseServerApplication::GetTypeId(void)
+    {
+        static TypeId tid = TypeId("ns3::WarehouseServerApplication")
+                                .SetParent<Application>()
+                                .AddConstructor<WarehouseServerApplication>()
+                                .AddAttribute("Port", "Porta em que o servidor recebe e envia quadros",
+                                              UintegerValue(5500),
+                                              MakeUintegerAccessor(&WarehouseServerApplication::m_port),
+                                              MakeUintegerChecker<uint16_t>())
+                                .AddAttribute("GatewayRelayAddress", "Endereço do intermediário entre gateway e servidor",
+                                              Ipv4AddressValue(),
+                                              MakeIpv4AddressAccessor(&WarehouseServerApplication::m_gatewayRelayAddress),
+                                              MakeIpv4AddressChecker())
+                                .AddAttribute("SensorRelayAddress", "Endereço do intermediário entre servidor e sensores",
+                                              Ipv4AddressValue(),
+                                              MakeIpv4AddressAccessor(&WarehouseServerApplication::m_sensorRelayAddress),
+                                              MakeIpv4AddressChecker())
+                                .AddAttribute("PollPeriod", "Intervalo entre verificações do estado dos sensores; zero desativa",
+                                              TimeValue(Seconds(1)),
+                                              MakeTimeAccessor(&WarehouseServerApplication::m_pollPeriod),
+                                              MakeTimeChecker())
+                                .AddAttribute("BatchWindow", "Espera máxima de um comando aceito antes de seguir em lote para os sensores; zero envia ao fim de cada quadro recebido",
+                                              TimeValue(Seconds(0)),
+                                              MakeTimeAccessor(&WarehouseServerApplication::m_batchWindow),
+                                              MakeTimeChecker())
+                                .AddAttribute("Coalesce", "Anula no lote os pares de comandos opostos sobre a mesma prateleira",
+                                              BooleanValue(false),
+                                              MakeBooleanAccessor(&WarehouseServerApplication::m_coalesce),
+                                              MakeBooleanChecker())
+                                .AddAttribute("Reliable", "Envia os quadros unicast com confirmação e reenvio",
+                                              BooleanValue(false),
+                                              MakeBooleanAccessor(&WarehouseServerApplication::m_reliable),
+                                              MakeBooleanChecker());
+        return tid;
+    }
+
+    TypeId WarehouseServerApplication::GetInstanceTypeId(void) const
+    {
+        return WarehouseServerApplication::GetTypeId();
+    }
+
+    WarehouseServerApplication::WarehouseServerApplication()
+    {
+        m_port = 5500;
+        m_coalesce = false;
+        m_reliable = false;
+        m_firstShelf = 1;
+        m_shelves = 0;
+        m_reportMissingGroup = NO_GROUP;
+        m_reportMissingMask = 0;
+        m_verifyReplies = 0;
+        m_verifyRounds = 0;
+        m_verifyMissing = 0;
+        m_log = 0;
+        m_latency = 0;
+        m_metrics = 0;
+    }
+
+    WarehouseServerApplication::~WarehouseServerApplication()
+    {
+    }
+
+    void WarehouseServerApplication::SetInitialStates(const ShelfStateTable &states, uint32_t firstShelf, uint32_t count)
+    {
+        NS_ASSERT(firstShelf >= 1 && firstShelf - 1 + count <= states.GetSize());
+        m_firstShelf = firstShelf;
+        m_shelves = count == 0 ? states.GetSize() - (firstShelf - 1) : count;
+        m_table.Resize(m_shelves);
+        for (uint32_t i = 0; i < m_shelves; i++)
+        {
+            m_table.Set(i, states.Get(firstShelf - 1 + i));
+        }
+        m_lastHeard.assign(m_shelves, Seconds(0));
+        m_batchIndex.assign(m_shelves, -1);
+    }
+
+    void WarehouseServerApplication::SetEventLog(EventLog *log)
+    {
+        m_log = log;
+    }
+
+    void WarehouseServerApplication::SetLatencyCollector(LatencyCollector *latency)
+    {
+        m_latency = latency;
+    }
+
+    void WarehouseServerApplication::SetMetrics(MetricsRegistry *metrics)
+    {
+        m_metrics = metrics;
+    }
+
+    void WarehouseServerApplication::StartApplication()
+    {
+        NS_LOG_FUNCTION(this);
+        TypeId tid = TypeId::LookupByName("ns3::UdpSocketFactory");
+        m_socket = Socket::CreateSocket(GetNode(), tid);
+        if (m_socket->Bind(InetSocketAddress(Ipv4Address::GetAny(), m_port)) == -1)
+        {
+            NS_FATAL_ERROR("Failed to bind socket");
+        }
+        m_socket->SetRecvCallback(MakeCallback(&WarehouseServerApplication::HandleRead, this));
+        m_socket->SetRecvPktInfo(true);
+        // Os registros são agrupados em quadros, um por próximo salto
+        m_writer = FrameWriter(m_socket, m_port);
+        m_arq = Create<ArqEndpoint>(m_socket, m_port, m_reliable);
+        m_writer.SetArq(m_arq);
+        if (m_metrics)
+        {
+            m_metricIds = m_metrics->AddNode(GetNode()->GetId(), "server");
+            m_writer.SetMetrics(m_metrics, m_metricIds);
+        }
+
+        if (m_pollPeriod.IsStrictlyPositive())
+        {
+            m_verifyEvent = Simulator::Schedule(m_pollPeriod, &WarehouseServerApplication::Verify, this);
+        }
+    }
+
+    void WarehouseServerApplication::StopApplication()
+    {
+        NS_LOG_FUNCTION(this);
+        Simulator::Cancel(m_verifyEvent);
+        Simulator::Cancel(m_batchEvent);
+        if (m_arq)
+        {
+            m_arq->Close();
+        }
+        if (m_socket)
+        {
+            m_socket->Close();
+            m_socket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
+        }
+    }
+
+    void WarehouseServerApplication::DoDispose()
+    {
+        m_socket = 0;
+        m_writer = FrameWriter();
+        m_arq = 0;
+        Application::DoDispose();
+    }
+
+    void WarehouseServerApplication::Verify()
+    {
+        m_verifyStart = Simulator::Now(); // respostas a rodadas anteriores não contam mais
+        m_verifyReplies = 0;
+        m_verifyRounds++;
+        ShelfRecord record;
+        record.source = SERVER_ID; // Server
+        record.dest = BROADCAST_ID; // Broadcast
+        record.command = COMMAND_VERIFY; // Verifica status dos sensores
+        record.payload = 0; // não importa, fica em 0
+        m_writer.Append(m_sensorRelayAddress, record);
+        m_writer.Flush();
+        m_verifyEvent = Simulator::Schedule(m_pollPeriod, &WarehouseServerApplication::Verify, this);
+    }
+
+    void WarehouseServerApplication::HandleRead(Ptr<Socket> socket)
+    {
+        NS_LOG_FUNCTION(this << socket);
+        Ptr<Packet> packet;
+        Address from;
+        while ((packet = socket->RecvFrom(from)))
+        {
+            uint32_t packetSize = packet->GetSize();
+            Ipv4Address senderAddress = InetSocketAddress::ConvertFrom(from).GetIpv4();
+            if (m_log)
+            {
+                m_log->LogPacket(GetNode()->GetId(), packetSize);
+            }
+            if (m_metrics)
+            {
+                m_metrics->OnPacket(m_metricIds, packetSize);
+            }
+
+            // Lógica para processar o pacote recebido
+            WarehouseFrame frame;
+            if (!ReadFrame(packet, frame)) // quadro com versão desconhecida ou tamanho inconsistente
+            {
+                NS_LOG_INFO("Quadro inválido descartado pelo servidor.");
+                if (m_log)
+                {
+                    m_log->LogInvalidFrame(GetNode()->GetId(), packetSize);
+                }
+                if (m_metrics)
+                {
+                    m_metrics->Increment(m_metricIds.invalidFrames);
+                }
+                continue;
+            }
+            if (frame.header.flags & FRAME_FLAG_BROADCAST) // verificação em difusão destinada aos sensores
+            {
+                continue;
+            }
+            if (!m_arq->Receive(senderAddress, frame.header, packetSize)) // confirmação ou quadro repetido
+            {
+                continue;
+            }
+            m_origin = LatencyTag(); // registros gerados a partir deste quadro herdam a origem do comando
+            packet->PeekPacketTag(m_origin);
+            m_reportMissingGroup = NO_GROUP;
+
+            for (uint16_t r = 0; r < frame.header.recordCount; r++)
+            {
+                const ShelfRecord &data = frame.records[r];
+                if (data.source == GATEWAY_ID) // Fonte é o gateway
+                {
+                    ApplySensorReports(); // relatos anteriores do mesmo quadro valem antes do comando
+                    HandleGatewayCommand(data, senderAddress);
+                }
+                else if (Owns(data.source)) // Fonte é um dos sensores deste servidor
+                {
+                    HandleSensorReport(data);
+                }
+                else if (GetNodeRole(data.source) == ROLE_RELAY && data.command == COMMAND_REPORT_MISSING) // sensores sem resposta na rodada agregada, de qualquer intermediário de sensores
+                {
+                    m_reportMissingGroup = data.dest;
+                    m_reportMissingMask = data.payload;
+                    m_verifyMissing += __builtin_popcount(data.payload);
+                    NS_LOG_INFO(__builtin_popcount(data.payload) << " sensores do grupo " << data.dest << " não responderam à verificação.");
+                }
+                else if (GetNodeRole(data.source) == ROLE_RELAY && data.command == COMMAND_REPORT) // relatório agregado de uma rodada de verificação
+                {
+                    // cada bit do payload é o estado de uma prateleira do grupo; as que não responderam vêm no registro anterior
+                    uint8_t missing = m_reportMissingGroup == data.dest ? m_reportMissingMask : 0;
+                    for (uint32_t bit = 0; bit < 8; bit++)
+                    {
+                        uint32_t shelf = data.dest * 8 + bit + 1;
+                        if (!Owns(shelf) || (missing & (1 << bit)))
+                        {
+                            continue;
+                        }
+                        ShelfRecord reply;
+                        reply.source = shelf; // mesma resposta que o sensor teria enviado
+                        reply.dest = SERVER_ID;
+                        reply.command = COMMAND_VERIFY;
+                        reply.payload = (data.payload >> bit) & 1;
+                        HandleSensorReport(reply);
+                    }
+                    m_reportMissingGroup = NO_GROUP;
+                }
+                else if (GetNodeRole(data.source) == ROLE_RELAY) // Fonte é um dos nós intermediários, indicando que houve erro
+                {
+                    NS_LOG_INFO("Erro No envio para Nó intermediário. Dados inválidos ou corrompidos.");
+                }
+                else // Fonte inválida
+                {
+                    NS_LOG_INFO("Identificador Fonte Inválido, finalizando comunicação.");
+                }
+
+                if (m_log)
+                {
+                    m_log->LogRecord(GetNode()->GetId(), data);
+                }
+                if (m_metrics)
+                {
+                    m_metrics->OnRecord(m_metricIds, data);
+                }
+            }
+            ApplySensorReports();
+            if (m_batchWindow.IsZero())
+            {
+                FlushBatch();
+            }
+            m_writer.Flush(); // envia um quadro para cada próximo salto com os registros processados
+        }
+    }
+
+    void WarehouseServerApplication::HandleGatewayCommand(const ShelfRecord &data, Ipv4Address sender)
+    {
+        ShelfRecord msg;
+        msg.source = SERVER_ID; // A nova mensagem tem como fonte o servidor
+        msg.payload = 0; // não importa, deixo em 0.
+
+        switch (data.command)
+        {
+        case COMMAND_VERIFY: // Comando recebido é não fazer nada.
+            break;
+        case COMMAND_EMPTY: // Comando recebido é esvaziar uma prateleira
+        case COMMAND_FILL: // Comando recebido é preencher uma prateleira
+            if (!Owns(data.payload)) // caso o payload esteja fora do intervalo permitido, isto é, não seja o identificador de alguma prateleira deste servidor
+            {
+                SendError(sender, ERROR_INVALID_DEST); // envia de volta para o nó intermediário entre servidor e gateway, indicando que sua solicitação foi inválida
+            }
+            else if (m_table.Get(data.payload - m_firstShelf) == (data.command == COMMAND_FILL)) // a prateleira já está no estado pedido
+            {
+                // esvaziar prateleira vazia ou preencher prateleira cheia
+                SendError(sender, data.command == COMMAND_EMPTY ? ERROR_SHELF_EMPTY : ERROR_SHELF_FULL); // envia de volta para o nó intermediário entre servidor e gateway, indicando que sua solicitação foi inválida
+            }
+            else // o servidor atualiza sua tabela de estados e solicita a mudança no estado da prateleira
+            {
+                m_table.Set(data.payload - m_firstShelf, data.command == COMMAND_FILL);
+                msg.dest = data.payload; // endereço da prateleira que deve ser esvaziada ou preenchida
+                msg.command = data.command; // codigo de mensagem de esvaziamento ou preenchimento de prateleira
+                QueueCommand(msg); // segue no próximo lote para o nó intermediário entre servidor e sensores
+            }
+            break;
+        default:
+            NS_LOG_INFO("Comando inválido");
+            break;
+        }
+    }
+
+    void WarehouseServerApplication::HandleSensorReport(const ShelfRecord &data)
+    {
+        m_lastHeard[data.source - m_firstShelf] = Simulator::Now();
+        if (data.command == COMMAND_VERIFY) // fim da volta da verificação iniciada pelo servidor
+        {
+            if (m_pollPeriod.IsZero() && m_origin.GetOrigin() > m_verifyStart) // rodada iniciada por outro servidor
+            {
+                m_verifyStart = m_origin.GetOrigin();
+                m_verifyReplies = 0;
+                m_verifyRounds++;
+            }
+            if (m_latency)
+            {
+                m_latency->Record(COMMAND_VERIFY, m_origin.GetElapsed(), m_origin.GetHops());
+            }
+            if (m_origin.GetOrigin() == m_verifyStart && ++m_verifyReplies == m_shelves) // último sensor da rodada respondeu
+            {
+                m_verifyCompletion.push_back(m_origin.GetElapsed().GetSeconds() * 1000.0);
+            }
+        }
+        // O relato é acumulado e comparado com a tabela do servidor junto com os demais relatos do quadro
+        if (!m_table.Stage(data.source - m_firstShelf, data.payload != 0)) // a prateleira já relatou neste quadro, aplica o relato anterior primeiro
+        {
+            ApplySensorReports();
+            m_table.Stage(data.source - m_firstShelf, data.payload != 0);
+        }
+        m_pendingReports.push_back(data);
+    }
+
+    /** Os relatos dos sensores de um quadro são aplicados à tabela de uma só vez. As discrepâncias
+     * geram erro 5 para o gateway; os relatos consistentes de esvaziamento ou preenchimento geram a mensagem de sucesso.
+     */
+    void WarehouseServerApplication::ApplySensorReports()
+    {
+        if (m_table.GetStagedCount() == 0)
+        {
+            return;
+        }
+        m_discrepancies.clear();
+        uint32_t nDiscrepancies = m_table.ApplyStaged(m_discrepancies);
+        uint32_t nVerified = 0;
+        if (m_metrics)
+        {
+            m_metrics->Increment(m_metricIds.discrepancies, nDiscrepancies);
+        }
+        for (uint32_t i = 0; i < nDiscrepancies; i++)
+        {
+            NS_LOG_INFO("Discrepância entre leitura esperada e real dos sensores, enviando mensagem de erro para Gateway.");
+            SendError(m_gatewayRelayAddress, ERROR_INCONSISTENT); // tentativa de inconsistência de valores: envia de volta para o nó intermediário entre servidor e gateway, indicando que ocorreu erro
+        }
+        for (const ShelfRecord &data : m_pendingReports)
+        {
+            if (std::binary_search(m_discrepancies.begin(), m_discrepancies.end(), (uint32_t)(data.source - m_firstShelf))) // relato inconsistente, já tratado acima
+            {
+                continue;
+            }
+            if (data.command == COMMAND_EMPTY || data.command == COMMAND_FILL) // Se o comando vier do gateway(1 ou 2), responde a ele com mensagem de sucesso.
+            {
+                SendSuccess(data.source, data.command, m_origin);
+            }
+            else // caso o comando seja 0(verificar estado dos sensores), não é necessário mandar nenhuma mensagem, visto que ele partiu do proprio servidor
+            {
+                nVerified++;
+            }
+        }
+        if (nVerified > 0)
+        {
+            NS_LOG_INFO("Verificação do estado dos sensores concluida com sucesso para " << nVerified << " prateleiras.");
+        }
+        m_pendingReports.clear();
+    }
+
+    void WarehouseServerApplication::QueueCommand(const ShelfRecord &record)
+    {
+        s_stats.commands++;
+        int32_t &index = m_batchIndex[record.dest - m_firstShelf];
+        if (m_coalesce && index >= 0 && m_batch[index].record.command != record.command)
+        {
+            // preencher e esvaziar a mesma prateleira se anulam: o sensor fica como estava e o gateway recebe os dois sucessos
+            BatchedCommand &previous = m_batch[index];
+            previous.live = false;
+            index = -1;
+            SendSuccess(record.dest, previous.record.command, previous.origin);
+            SendSuccess(record.dest, record.command, m_origin);
+            s_stats.coalesced += 2;
+            return;
+        }
+
+        BatchedCommand command;
+        command.nextHop = m_sensorRelayAddress;
+        command.record = record;
+        command.origin = m_origin;
+        command.live = true;
+        index = m_batch.size();
+        m_batch.push_back(command);
+        if (!m_batchWindow.IsZero() && !m_batchEvent.IsRunning())
+        {
+            m_batchEvent = Simulator::Schedule(m_batchWindow, &WarehouseServerApplication::FlushBatch, this);
+        }
+    }
+
+    void WarehouseServerApplication::FlushBatch()
+    {
+        Simulator::Cancel(m_batchEvent);
+        uint32_t live = 0;
+        for (uint32_t i = 0; i < m_batch.size(); i++)
+        {
+            const BatchedCommand &command = m_batch[i];
+            if (command.live)
+            {
+                m_writer.Append(command.nextHop, command.record, command.origin);
+                m_batchIndex[command.record.dest - m_firstShelf] = -1;
+                live++;
+            }
+        }
+        m_batch.clear();
+        if (live == 0)
+        {
+            return;
+        }
+        s_stats.batches++;
+        if (live > 1)
+        {
+            s_stats.batchedCommands += live;
+        }
+        m_writer.Flush();
+    }
+
+    void WarehouseServerApplication::SendSuccess(uint32_t shelf, uint8_t command, const LatencyTag &origin)
+    {
+        ShelfRecord msg;
+        msg.source = SERVER_ID; // A nova mensagem tem como fonte o servidor
+        msg.dest = shelf; // endereço da prateleira que foi esvaziada ou preenchida
+        msg.command = command; // codigo de mensagem de esvaziamento ou preenchimento de prateleira
+        msg.payload = 0; // não importa, deixo em 0.
+        m_writer.Append(m_gatewayRelayAddress, msg, origin); // repassa a mensagem de sucesso para o nó intermediário entre servidor e gateway
+    }
+
+    void WarehouseServerApplication::SendError(Ipv4Address to, uint8_t code)
+    {
+        ShelfRecord errorMsg;
+        errorMsg.source = SERVER_ID; // quem manda é o servidor
+        errorMsg.dest = GATEWAY_ID; // endereço de gateway
+        errorMsg.command = COMMAND_ERROR; // codigo de mensagem de erro
+        errorMsg.payload = code;
+        m_writer.Append(to, errorMsg, m_origin);
+        if (m_metrics)
+        {
+            m_metrics->Increment(m_metricIds.errorsSent[code]);
+        }
+    }
+
+    bool WarehouseServerApplication::Owns(uint32_t shelf) const
+    {
+        return shelf >= m_firstShelf && shelf < m_firstShelf + m_shelves;
+    }
+
+    uint32_t WarehouseServerApplication::GetFirstShelf() const
+    {
+        return m_firstShelf;
+    }
+
+    uint32_t WarehouseServerApplication::GetShelfCount() const
+    {
+        return m_shelves;
+    }
+
+    const ShelfStateTable &WarehouseServerApplication::GetStateTable() const
+    {
+        return m_table;
+    }
+
+    Time WarehouseServerApplication::GetLastHeard(uint32_t shelf) const
+    {
+        return m_lastHeard[shelf];
+    }
+
+    uint32_t WarehouseServerApplication::GetVerifyRounds() const
+    {
+        return m_verifyRounds;
+    }
+
+    const std::vector<double> &WarehouseServerApplication::GetVerifyCompletion() const
+    {
+        return m_verifyCompletion;
+    }
+
+    uint32_t WarehouseServerApplication::GetVerifyMissing() const
+    {
+        return m_verifyMissing;
+    }
+
+    const ServerBatchStats &WarehouseServerApplication::GetStats()
+    {
+        return s_stats;
+    }
+}
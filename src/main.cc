@@ -9,1046 +9,828 @@
 #include "ns3/applications-module.h"
 #include "ns3/internet-apps-module.h"
 #include "ns3/netanim-module.h"
+#include "components/include/warehouse-protocol.h"
+#include "components/include/frame-writer.h"
+#include "components/include/shelf-reading-source.h"
+#include "components/include/shelf-sensor-application.h"
+#include "components/include/instance-loader.h"
+#include "components/include/shelf-state-table.h"
+#include "components/include/latency-tag.h"
+#include "components/include/latency-collector.h"
+#include "components/include/event-log.h"
+#include "components/include/warehouse-relay-application.h"
+#include "components/include/arq-endpoint.h"
+#include "components/include/gateway-client-application.h"
+#include "components/include/gateway-load-generator.h"
+#include "components/include/warehouse-server-application.h"
+#include "components/include/metrics-registry.h"
+#include "components/include/address-planner.h"
+#include "components/include/aisle-topology-helper.h"
+#include "components/include/cached-propagation-model.h"
+#include <algorithm>
+#include <chrono>
 #include <fstream>
+#include <map>
 #include <vector>
 
-#define SENSOR_ADDRESS "10.1.1.0"
-#define INTERMEDIATE_ADDRESS "10.1.2.0"
-#define SERVER_ADDRESS "10.1.3.0"
-#define GATEWAY_ADDRESS "10.1.4.0"
 
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE("main");
 
-//leitura de sensores
-std::queue<bool> shelf1;
-std::queue<bool> shelf2;
-std::queue<bool> shelf3;
-std::queue<bool> shelf4;
-std::queue<bool> shelf5;
-std::queue<bool> shelf6;
-std::queue<int> gateway_commands;
-std::queue<int> gateway_target;
-std::vector<bool> server_state_table;
-std::vector<bool> sensor_state_vector;
-
-int loadFile(void){
-    std::ifstream file("/home/mai/Documents/Redes_sem_Fio/src/data/instance.txt");
-    std::cout << "opening file" << std::endl;
-
-    if (file.fail()) {
-        std::cout << "Erro ao abrir o arquivo. Detalhes: " << std::strerror(errno) << std::endl;
+//leitura de sensores, lidas sob demanda do arquivo de instância mapeado em memória
+Ptr<InstanceFile> instance;
+RowCursor gateway_commands;
+RowCursor gateway_target;
+ShelfStateTable server_state_table; // estado inicial de cada prateleira, primeira leitura do seu sensor
+LatencyCollector latency; // latências de ponta a ponta dos comandos, medidas no gateway e no servidor
+EventLog eventLog; // eventos de pacotes e registros, gravados em arquivo em vez de impressos a cada pacote
+MetricsRegistry metrics; // contadores, medidores e histogramas por nó, gravados em JSON no Simulator::Destroy()
+Time airtime; // soma do tempo de transmissão de todos os rádios
+uint64_t codec_allocations_started = 0; // alocações da codificação até todas as aplicações começarem
+
+void snapshotCodecAllocations(){
+    codec_allocations_started = GetCodecAllocationStats().allocations;
+}
+/** Tempo em que algum rádio de um canal 802.11 transmitia, na topologia de corredores */
+typedef struct {
+    Time busy; // união dos intervalos de transmissão já encerrados
+    Time busyUntil; // fim do último intervalo da união
+} ChannelBusyTime;
+std::map<uint8_t, ChannelBusyTime> channel_busy;
+
+int loadFile(const std::string& path){
+    std::cout << "opening file " << path << std::endl;
+    instance = Create<InstanceFile>();
+    if (!instance->Open(path)) {
+        std::cout << "Erro ao abrir o arquivo. Detalhes: " << instance->GetError() << std::endl;
+        return 1; // Return an error code
     }
 
-
-    if(file.is_open()) {
-        std::cout << "file is open" << std::endl;
-        int number;
-        int count = 0;
-        int nCols = 10;
-        while (file >> number) {
-            if (count < nCols)
-            {
-                shelf1.push(number);
-            }else if (count < 2 * nCols)
-            {
-                shelf2.push(number);
-            }else if (count < 3 * nCols)
-            {
-                shelf3.push(number);
-            }else if (count < 4 * nCols)
-            {
-                shelf4.push(number);
-            }else if (count < 5 * nCols)
-            {
-                shelf5.push(number);
-            }else if (count < 6 * nCols)
-            {
-                shelf6.push(number);
-            }else if (count < 7 * nCols)
-            {
-                gateway_commands.push(number);
-            }else if (count < 8 * nCols)
-            {
-                gateway_target.push(number);
-            }
-            count++;
-        }
-        file.close();
-        std::cout << "file is closed" << std::endl;
-        server_state_table.push_back(shelf1.front());
-        server_state_table.push_back(shelf2.front());
-        server_state_table.push_back(shelf3.front());
-        server_state_table.push_back(shelf4.front());
-        server_state_table.push_back(shelf5.front());
-        server_state_table.push_back(shelf6.front());
-        for(uint i = 0; i < server_state_table.size(); i++){
-            sensor_state_vector.push_back(server_state_table[i]);
-        }
-    } else {
-        std::cout << "Unable to open the file." << std::endl;
-        return 1; // Return an error code
+    gateway_commands = instance->GetGatewayCommands();
+    gateway_target = instance->GetGatewayTargets();
+    // O estado inicial de cada prateleira no servidor é a primeira leitura do seu sensor
+    server_state_table.Resize(instance->GetShelfCount());
+    for(uint32_t i = 0; i < instance->GetShelfCount(); i++){
+        RowCursor row = instance->GetShelfRow(i);
+        server_state_table.Set(i, row.HasNext() && row.Peek() != 0);
     }
+    std::cout << "file is mapped (" << (instance->IsBinary() ? "binary" : "text") << "): " << instance->GetShelfCount() << " shelves" << std::endl;
     return 0;
 }
 
-typedef struct{
-    uint8_t source;
-    uint8_t dest;
-    uint8_t command;
-    uint8_t payload;
-} messageData;
-
-void gatewayEvent(Ptr<Socket> skt, Ipv4Address dest){
-    uint8_t* buffer = (uint8_t*)malloc(sizeof(messageData));
-    buffer[0] = 13; // Gateway
-    buffer[1] = 10; // Server
-    buffer[2] = gateway_commands.front(); // Primeiro elemento da fila das leituras de gateway[0], iindicando o comando a ser executado
-    gateway_commands.pop();
-    buffer[3] = gateway_target.front(); // Primeiro elemento da fila das leituras de gateway[1], indicando qual sensor é o alvo do comando
-    gateway_target.pop();
-    Ptr<Packet> pkt = Create<Packet>(buffer, sizeof(messageData));
-    skt->SendTo(pkt, 0, InetSocketAddress(dest, 5500));
+void phyStateTrace(std::string context, Time start, Time duration, WifiPhyState state){
+    if(state == WifiPhyState::TX){
+        airtime += duration;
+    }
 }
 
-void verify(Ptr<Socket> skt, Ipv4Address dest){
-    uint8_t* buffer = (uint8_t*)malloc(sizeof(messageData));
-    buffer[0] = 10; // Server
-    buffer[1] = 0; // Broadcast
-    buffer[2] = 0; // Verifica status dos sensores
-    buffer[3] = 0; // não importa, fica em 0
-    Ptr<Packet> pkt = Create<Packet>(buffer, sizeof(messageData));
-    skt->SendTo(pkt, 0, InetSocketAddress(dest, 5500));
-    std::cout << InetSocketAddress(dest, 5500) <<std::endl;
+/** Células do mesmo canal fora do alcance umas das outras transmitem ao mesmo tempo, então os intervalos de
+ * transmissão são unidos antes de somados. A PHY registra cada transmissão no seu início, logo os intervalos
+ * chegam em ordem de início e basta lembrar o fim do último. */
+void channelStateTrace(uint8_t channel, Time start, Time duration, WifiPhyState state){
+    if(state == WifiPhyState::TX){
+        ChannelBusyTime& busy = channel_busy[channel];
+        Time end = start + duration;
+        if(end > busy.busyUntil){
+            busy.busy += end - std::max(start, busy.busyUntil);
+            busy.busyUntil = end;
+        }
+    }
 }
 
-int main(){
-
-    loadFile();
-    LogComponentEnable("main", LOG_LEVEL_ALL);
-    NodeContainer sensorNodes;
-    sensorNodes.Create(6);
+/** Padrões aceitos em --standard */
+bool parseWifiStandard(const std::string& name, WifiStandard& standard){
+    if(name == "80211a") standard = WIFI_STANDARD_80211a;
+    else if(name == "80211b") standard = WIFI_STANDARD_80211b;
+    else if(name == "80211g") standard = WIFI_STANDARD_80211g;
+    else if(name == "80211n") standard = WIFI_STANDARD_80211n;
+    else if(name == "80211ac") standard = WIFI_STANDARD_80211ac;
+    else if(name == "80211ax") standard = WIFI_STANDARD_80211ax;
+    else return false;
+    return true;
+}
 
-    NodeContainer intermediateNodes;
-    intermediateNodes.Create(2);
+int main(int argc, char* argv[]){
+
+    std::string instancePath = "scratch/src/data/instance.txt";
+    std::string convertPath = "";
+    std::string summaryPath = "";
+    bool verbose = true;
+    uint32_t eventLogLevel = EVENT_LOG_NONE;
+    std::string eventLogPath = "events.csv";
+    std::string eventLogFormat = "csv";
+    uint32_t eventLogCapacity = EventLog::DEFAULT_CAPACITY;
+    std::string metricsPath = "";
+    std::string verifyMode = "unicast";
+    double replyJitter = 0.0;
+    double aggregationWindow = 0.0;
+    bool deltaReporting = false;
+    uint32_t heartbeatPolls = 10;
+    uint32_t nSensors = 0; // 0 = uma por prateleira da instância
+    bool reliable = false;
+    double errorRate = 0.0;
+    uint32_t macRetries = 7;
+    // Wi-Fi
+    std::string standardName = "80211ac";
+    std::string dataMode = "VhtMcs9";
+    std::string controlMode = "VhtMcs0";
+    uint32_t channelWidth = 20;
+    // Tempos, em segundos
+    double pollPeriod = 1.0;
+    uint32_t gatewayEvents = 10;
+    uint32_t gatewayWindow = 0;
+    double gatewayTimeout = 1.0;
+    std::string load = "instance";
+    double loadRate = 10.0;
+    double loadOnTime = 1.0;
+    double loadOffTime = 1.0;
+    std::string loadTrace = "";
+    double zipfExponent = 0.0;
+    double fillRatio = 0.5;
+    uint32_t serverShards = 1;
+    uint32_t shelvesPerAisle = 128;
+    std::string topology = "flat";
+    std::string backhaul = "csma";
+    std::string backhaulRate = "100Mbps";
+    double backhaulDelay = 50.0;
+    double aisleSpacing = 10.0;
+    double aisleShelfSpacing = 2.0; // a topologia plana usa shelfSpacing e shelfHeight, de dezenas de metros
+    double aisleShelfHeight = 2.0;
+    double interferenceRange = 30.0;
+    uint32_t cellChannels = 0; // 0 = todos os canais sem sobreposição da banda
+    bool propagationCache = true;
+    double batchWindow = 0.0;
+    bool coalesce = false;
+    double gatewayStart = 0.5;
+    double gatewayPeriod = 1.0;
+    double stopTime = 11.0;
+    uint32_t port = 5500;
+    // Posições, em metros
+    double gatewayX = 0.0, gatewayY = 0.0;
+    double serverX = 100.0, serverY = 100.0;
+    double relayGX = 50.0, relayGY = 50.0;
+    double relaySX = 150.0, relaySY = 100.0;
+    double shelfX = 175.0, shelfY = 125.0;
+    double shelfSpacing = 25.0;
+    double shelfHeight = 10.0;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("instance", "Arquivo de instância (texto ou binário) com as leituras das prateleiras e os comandos do gateway", instancePath);
+    cmd.AddValue("convert", "Converte a instância para o formato binário neste arquivo e encerra sem simular", convertPath);
+    cmd.AddValue("summary", "Arquivo CSV onde as métricas da execução são gravadas ao fim da simulação (usado por sweep.sh)", summaryPath);
+    cmd.AddValue("verbose", "Habilita as mensagens NS_LOG do componente main", verbose);
+    cmd.AddValue("eventLogLevel", "Eventos registrados: 0 = nenhum, 1 = pacotes recebidos, 2 = também cada registro", eventLogLevel);
+    cmd.AddValue("eventLog", "Arquivo do registro de eventos", eventLogPath);
+    cmd.AddValue("eventLogFormat", "Formato do registro de eventos: csv ou binary", eventLogFormat);
+    cmd.AddValue("metrics", "Arquivo JSON onde as métricas de cada nó são gravadas ao fim da simulação (vazio = desativadas)", metricsPath);
+    cmd.AddValue("eventLogCapacity", "Eventos mantidos em memória antes de cada gravação no arquivo", eventLogCapacity);
+    cmd.AddValue("verifyMode", "Entrega da verificação aos sensores: unicast (um quadro por sensor) ou broadcast (um quadro em difusão)", verifyMode);
+    cmd.AddValue("replyJitter", "Atraso máximo, em segundos, sorteado por sensor para responder a uma verificação", replyJitter);
+    cmd.AddValue("aggregationWindow", "Janela, em segundos, em que o intermediário agrega as respostas a uma verificação em um único relatório (0 = sem agregação)", aggregationWindow);
+    cmd.AddValue("deltaReporting", "Sensores só respondem à verificação quando o estado muda; o servidor trata o silêncio como estado inalterado", deltaReporting);
+    cmd.AddValue("heartbeatPolls", "Com deltaReporting, verificações sem resposta antes de um sinal de vida do sensor (0 = nunca)", heartbeatPolls);
+    cmd.AddValue("reliable", "Todos os nós enviam os quadros unicast com confirmação, RTO adaptativo e reenvio", reliable);
+    cmd.AddValue("errorRate", "Probabilidade de um quadro recebido por qualquer rádio ser descartado (RateErrorModel)", errorRate);
+    cmd.AddValue("macRetries", "Tentativas de transmissão de um quadro unicast pela camada MAC 802.11 (MaxSsrc)", macRetries);
+    cmd.AddValue("sensors", "Quantidade de sensores, no máximo a quantidade de prateleiras da instância (0 = todas)", nSensors);
+    cmd.AddValue("standard", "Padrão Wi-Fi: 80211a, 80211b, 80211g, 80211n, 80211ac ou 80211ax", standardName);
+    cmd.AddValue("dataMode", "Modo (MCS) dos quadros de dados do ConstantRateWifiManager", dataMode);
+    cmd.AddValue("controlMode", "Modo (MCS) dos quadros de controle do ConstantRateWifiManager", controlMode);
+    cmd.AddValue("channelWidth", "Largura do canal em MHz", channelWidth);
+    cmd.AddValue("pollPeriod", "Intervalo entre verificações do servidor, em segundos", pollPeriod);
+    cmd.AddValue("gatewayEvents", "Quantidade de comandos enviados pelo gateway (0 = todos os comandos da instância)", gatewayEvents);
+    cmd.AddValue("gatewayStart", "Instante do primeiro comando do gateway, em segundos", gatewayStart);
+    cmd.AddValue("gatewayPeriod", "Intervalo entre comandos do gateway, em segundos, com gatewayWindow = 0", gatewayPeriod);
+    cmd.AddValue("gatewayWindow", "Comandos do gateway pendentes ao mesmo tempo; o próximo sai assim que chega uma resposta (0 = ritmo fixo de gatewayPeriod)", gatewayWindow);
+    cmd.AddValue("gatewayTimeout", "Prazo, em segundos, para a resposta a um comando do gateway antes de liberar sua vaga na janela", gatewayTimeout);
+    cmd.AddValue("load", "Origem dos comandos do gateway: instance (linhas da instância), poisson, onoff ou trace (malha aberta)", load);
+    cmd.AddValue("loadRate", "Comandos por segundo com load=poisson, ou durante as rajadas com load=onoff", loadRate);
+    cmd.AddValue("loadOnTime", "Duração média, em segundos, das rajadas com load=onoff", loadOnTime);
+    cmd.AddValue("loadOffTime", "Duração média, em segundos, dos silêncios com load=onoff", loadOffTime);
+    cmd.AddValue("loadTrace", "Arquivo com uma linha \"instante comando alvo\" por comando, para load=trace", loadTrace);
+    cmd.AddValue("zipfExponent", "Expoente de Zipf na escolha das prateleiras alvo da carga sorteada (0 = uniforme)", zipfExponent);
+    cmd.AddValue("fillRatio", "Fração de comandos de preencher na carga sorteada", fillRatio);
+    cmd.AddValue("serverShards", "Servidores, cada um dono de um intervalo contíguo de grupos de 8 prateleiras", serverShards);
+    cmd.AddValue("shelvesPerAisle", "Prateleiras por corredor; cada corredor recebe a sua própria sub-rede", shelvesPerAisle);
+    cmd.AddValue("topology", "Topologia: flat (todos os nós em um único canal) ou aisles (um ponto de acesso por corredor, com backhaul cabeado)", topology);
+    cmd.AddValue("backhaul", "Com topology=aisles, ligação dos pontos de acesso: csma (rede local da infraestrutura) ou p2p (um enlace cada até o intermediário dos sensores)", backhaul);
+    cmd.AddValue("backhaulRate", "Taxa dos enlaces cabeados", backhaulRate);
+    cmd.AddValue("backhaulDelay", "Atraso dos enlaces cabeados, em microssegundos", backhaulDelay);
+    cmd.AddValue("aisleSpacing", "Distância em x entre corredores, com topology=aisles", aisleSpacing);
+    cmd.AddValue("aisleShelfSpacing", "Distância em y entre pares de prateleiras de um corredor, com topology=aisles", aisleShelfSpacing);
+    cmd.AddValue("aisleShelfHeight", "Altura da prateleira de cima de cada par de um corredor, com topology=aisles", aisleShelfHeight);
+    cmd.AddValue("interferenceRange", "Com topology=aisles, distância entre pontos de acesso abaixo da qual as células não repetem o canal", interferenceRange);
+    cmd.AddValue("propagationCache", "Memoriza a perda e o atraso de propagação de cada par de nós parados em vez de recalculá-los a cada quadro", propagationCache);
+    cmd.AddValue("cellChannels", "Com topology=aisles, número máximo de canais distintos para as células (0 = todos os canais sem sobreposição)", cellChannels);
+    cmd.AddValue("batchWindow", "Espera máxima, em segundos, de um comando aceito pelo servidor antes de seguir em lote para os sensores (0 = um lote por quadro recebido)", batchWindow);
+    cmd.AddValue("coalesce", "O servidor anula no lote os pares de preencher e esvaziar a mesma prateleira, sem acionar o sensor", coalesce);
+    cmd.AddValue("stopTime", "Duração da simulação, em segundos", stopTime);
+    cmd.AddValue("port", "Porta UDP usada por todos os nós", port);
+    cmd.AddValue("gatewayX", "Posição x do gateway", gatewayX);
+    cmd.AddValue("gatewayY", "Posição y do gateway", gatewayY);
+    cmd.AddValue("serverX", "Posição x do servidor", serverX);
+    cmd.AddValue("serverY", "Posição y do servidor", serverY);
+    cmd.AddValue("relayGX", "Posição x do intermediário entre gateway e servidor", relayGX);
+    cmd.AddValue("relayGY", "Posição y do intermediário entre gateway e servidor", relayGY);
+    cmd.AddValue("relaySX", "Posição x do intermediário entre sensores e servidor", relaySX);
+    cmd.AddValue("relaySY", "Posição y do intermediário entre sensores e servidor", relaySY);
+    cmd.AddValue("shelfX", "Posição x da primeira prateleira", shelfX);
+    cmd.AddValue("shelfY", "Posição y da primeira prateleira", shelfY);
+    cmd.AddValue("shelfSpacing", "Distância em y entre pares de prateleiras", shelfSpacing);
+    cmd.AddValue("shelfHeight", "Altura da prateleira de cima de cada par", shelfHeight);
+    cmd.Parse(argc, argv);
+
+    WifiStandard standard;
+    if(!parseWifiStandard(standardName, standard)){
+        std::cout << "Padrão Wi-Fi desconhecido: " << standardName << std::endl;
+        return 1;
+    }
+    if(eventLogLevel > EVENT_LOG_RECORDS || (eventLogFormat != "csv" && eventLogFormat != "binary")){
+        std::cout << "Nível ou formato do registro de eventos inválido." << std::endl;
+        return 1;
+    }
+    if(verifyMode != "unicast" && verifyMode != "broadcast"){
+        std::cout << "Modo de verificação desconhecido: " << verifyMode << std::endl;
+        return 1;
+    }
+    if(errorRate < 0 || errorRate > 1){
+        std::cout << "A taxa de erro deve estar entre 0 e 1." << std::endl;
+        return 1;
+    }
+    if(load != "instance" && load != "poisson" && load != "onoff" && load != "trace"){
+        std::cout << "Origem de comandos desconhecida: " << load << std::endl;
+        return 1;
+    }
+    if(loadRate <= 0 || loadOnTime <= 0 || loadOffTime < 0 || zipfExponent < 0 || fillRatio < 0 || fillRatio > 1){
+        std::cout << "Parâmetros da carga do gateway inválidos." << std::endl;
+        return 1;
+    }
+    if(pollPeriod <= 0 || gatewayPeriod <= 0 || gatewayTimeout <= 0 || stopTime <= 0 || batchWindow < 0){
+        std::cout << "Os intervalos e a duração da simulação devem ser positivos." << std::endl;
+        return 1;
+    }
 
-    NodeContainer serverNode;
-    serverNode.Create(1);
+    if(loadFile(instancePath) != 0){
+        return 1;
+    }
+    if(!convertPath.empty()){ // apenas conversão de formato, sem simulação
+        if(!instance->WriteBinary(convertPath)){
+            std::cout << "Erro ao gravar o arquivo binário. Detalhes: " << instance->GetError() << std::endl;
+            return 1;
+        }
+        std::cout << "Instância gravada em formato binário em " << convertPath << std::endl;
+        return 0;
+    }
+    if(verbose){
+        LogComponentEnable("main", LOG_LEVEL_ALL);
+    }
+    if(!eventLog.Configure((EventLogLevel)eventLogLevel, eventLogCapacity, eventLogPath,
+                           eventLogFormat == "binary" ? EventLog::BINARY : EventLog::CSV)){
+        std::cout << "Erro ao abrir o registro de eventos " << eventLogPath << std::endl;
+        return 1;
+    }
+    if(!metrics.Configure(metricsPath)){
+        std::cout << "Erro ao abrir o arquivo de métricas " << metricsPath << std::endl;
+        return 1;
+    }
+    MetricsRegistry* nodeMetrics = metrics.IsEnabled() ? &metrics : 0; // sem arquivo, os papéis não contam nada
+    Simulator::ScheduleDestroy(&MetricsRegistry::Dump, &metrics);
+    if(nSensors == 0){
+        nSensors = instance->GetShelfCount();
+    }
+    if(nSensors > instance->GetShelfCount()){
+        std::cout << "A instância tem apenas " << instance->GetShelfCount() << " prateleiras, não é possível simular " << nSensors << " sensores." << std::endl;
+        return 1;
+    }
+    server_state_table.Resize(nSensors); // apenas as prateleiras simuladas
+    uint32_t nGroups = (nSensors + 7) / 8; // os relatórios agregados cobrem grupos de 8 prateleiras, que não se dividem entre servidores
+    if(serverShards == 0 || serverShards > nGroups){
+        std::cout << "Com " << nSensors << " sensores, o servidor pode ser dividido em 1 a " << nGroups << " nós." << std::endl;
+        return 1;
+    }
+    if(shelvesPerAisle == 0 || shelvesPerAisle > AddressPlanner::MAX_SUBNET_HOSTS){
+        std::cout << "Um corredor tem de 1 a " << AddressPlanner::MAX_SUBNET_HOSTS << " prateleiras." << std::endl;
+        return 1;
+    }
+    uint32_t nAisles = (nSensors + shelvesPerAisle - 1) / shelvesPerAisle;
+    if(topology != "flat" && topology != "aisles"){
+        std::cout << "Topologia desconhecida: " << topology << std::endl;
+        return 1;
+    }
+    if(backhaul != "csma" && backhaul != "p2p"){
+        std::cout << "Backhaul desconhecido: " << backhaul << std::endl;
+        return 1;
+    }
+    // Banda do padrão e canais sem sobreposição que as células podem usar
+    WifiPhyBand band = (standard == WIFI_STANDARD_80211b || standard == WIFI_STANDARD_80211g || standard == WIFI_STANDARD_80211n)
+                       ? WIFI_PHY_BAND_2_4GHZ : WIFI_PHY_BAND_5GHZ;
+    std::vector<uint8_t> channelPlan = AisleTopologyHelper::GetNonOverlappingChannels(band, channelWidth);
+    if(cellChannels > 0 && cellChannels < channelPlan.size()){
+        channelPlan.resize(cellChannels);
+    }
+    if(topology == "aisles" && channelPlan.empty()){
+        std::cout << "Não há canais de " << channelWidth << " MHz na banda do padrão " << standardName << "." << std::endl;
+        return 1;
+    }
+    if(topology == "aisles" && nAisles > 1 && shelvesPerAisle % 8 != 0){ // um grupo de relatório agregado não pode ficar em duas células
+        std::cout << "Com topology=aisles, shelvesPerAisle deve ser múltiplo de 8." << std::endl;
+        return 1;
+    }
+    if(nAisles > AddressPlanner::MAX_AISLES){
+        std::cout << "Com " << shelvesPerAisle << " prateleiras por corredor, os " << nSensors << " sensores ocupariam " << nAisles
+                  << " corredores, mais que os " << AddressPlanner::MAX_AISLES << " do plano de endereços." << std::endl;
+        return 1;
+    }
 
-    NodeContainer gatewayNode;
-    gatewayNode.Create(1);
+    uint32_t nShelves = nSensors;
+    NodeContainer sensorNodes, intermediateNodes, serverNode, gatewayNode;
+    Ipv4InterfaceContainer sensorInterfaces, intermediateInterfaces, serverInterface, gatewayInterface;
+    AddressPlanner planner;
+    AisleTopologyHelper aisleTopology(nShelves, shelvesPerAisle);
 
     //Create WIFI helper
+    // Com as retransmissões da MAC, boa parte das perdas não chega à aplicação; --macRetries=1 as desativa
+    Config::SetDefault("ns3::WifiRemoteStationManager::MaxSsrc", UintegerValue(macRetries));
     WifiHelper wifi;
-    wifi.SetStandard(WIFI_STANDARD_80211ac);
-    wifi.SetRemoteStationManager("ns3::ConstantRateWifiManager", "DataMode", StringValue("VhtMcs9"),
-                                 "ControlMode", StringValue("VhtMcs0"));
-    Config::Set("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/ChannelWidth", UintegerValue(20));
+    wifi.SetStandard(standard);
+    wifi.SetRemoteStationManager("ns3::ConstantRateWifiManager", "DataMode", StringValue(dataMode),
+                                 "ControlMode", StringValue(controlMode));
 
     //Create WIFI helpers for layers 1 and 2
+    // Os mesmos modelos de YansWifiChannelHelper::Default(), LogDistance e velocidade constante, mas calculados uma
+    // única vez por par de nós, pois nenhum nó do armazém se move
     YansWifiChannelHelper channel = YansWifiChannelHelper::Default();
+    if(propagationCache){
+        channel = YansWifiChannelHelper();
+        channel.SetPropagationDelay("ns3::CachedPropagationDelayModel");
+        channel.AddPropagationLoss("ns3::CachedPropagationLossModel");
+    }
     YansWifiPhyHelper phy;
-    phy.SetChannel(channel.Create());
-
-    //Create WIFI helpers for MAC addressing
-    WifiMacHelper mac;
-    Ssid ssid = Ssid("ns-3-ssid");
-
-    //Create a WIFI device container for the structured network
-    NetDeviceContainer sensorDevices, serverDevice, gatewayDevice, intermediateDevices;
-    mac.SetType("ns3::StaWifiMac", "Ssid", SsidValue(ssid), "ActiveProbing", BooleanValue(false));
-    sensorDevices = wifi.Install(phy, mac, sensorNodes);
-    intermediateDevices = wifi.Install(phy, mac, intermediateNodes);
-    serverDevice = wifi.Install(phy, mac, serverNode);
-    gatewayDevice = wifi.Install(phy, mac, gatewayNode);
- 
-
-    // ----------------------- NODE MOBILITY SECTION ------------------------------------------
-    
-    MobilityHelper sensorMobility, intermediateMobility, serverMobility, gatewayMobility;
-
-    Ptr<ConstantPositionMobilityModel> gatewayMobilityModel = CreateObject<ConstantPositionMobilityModel>();
-    double xCoord = 0.0;
-    double yCoord = 0.0;
-    double zCoord = 0.0;
-    gatewayMobilityModel->SetPosition(ns3::Vector(xCoord, yCoord, zCoord));
-    gatewayNode.Get(0)->AggregateObject(gatewayMobilityModel);
-
-    Ptr<ConstantPositionMobilityModel> serverMobilityModel = CreateObject<ConstantPositionMobilityModel>();
-    xCoord = 100.0;
-    yCoord = 100.0;
-    serverMobilityModel->SetPosition(ns3::Vector(xCoord, yCoord, zCoord));
-    serverNode.Get(0)->AggregateObject(serverMobilityModel);
+    if(topology == "aisles"){ // um ponto de acesso por corredor, ligado à infraestrutura por cabo
+        aisleTopology.SetServers(serverShards);
+        aisleTopology.SetBackhaul(backhaul == "p2p" ? AisleTopologyHelper::BACKHAUL_P2P : AisleTopologyHelper::BACKHAUL_CSMA,
+                                  backhaulRate, MicroSeconds(backhaulDelay));
+        aisleTopology.SetLayout(aisleSpacing, aisleShelfSpacing, aisleShelfHeight);
+        aisleTopology.SetChannels(band, channelWidth, channelPlan);
+        aisleTopology.SetInterferenceRange(interferenceRange);
+        aisleTopology.Build(wifi, phy, channel, planner);
+        sensorNodes = aisleTopology.GetSensors();
+        intermediateNodes = aisleTopology.GetRelays();
+        serverNode = aisleTopology.GetServers();
+        gatewayNode = aisleTopology.GetGateway();
+        sensorInterfaces = aisleTopology.GetSensorInterfaces();
+        intermediateInterfaces = aisleTopology.GetRelayInterfaces();
+        serverInterface = aisleTopology.GetServerInterfaces();
+        gatewayInterface = aisleTopology.GetGatewayInterfaces();
+    }else{ // todos os nós em um único canal, sem ponto de acesso
+        sensorNodes.Create(nShelves);
+        intermediateNodes.Create(2);
+        serverNode.Create(serverShards);
+        gatewayNode.Create(1);
+        phy.SetChannel(channel.Create());
+
+        //Create WIFI helpers for MAC addressing
+        WifiMacHelper mac;
+        Ssid ssid = Ssid("ns-3-ssid");
+
+        //Create a WIFI device container for the structured network
+        NetDeviceContainer sensorDevices, serverDevice, gatewayDevice, intermediateDevices;
+        mac.SetType("ns3::StaWifiMac", "Ssid", SsidValue(ssid), "ActiveProbing", BooleanValue(false));
+        sensorDevices = wifi.Install(phy, mac, sensorNodes);
+        intermediateDevices = wifi.Install(phy, mac, intermediateNodes);
+        serverDevice = wifi.Install(phy, mac, serverNode);
+        gatewayDevice = wifi.Install(phy, mac, gatewayNode);
+
+        // ----------------------- NODE MOBILITY SECTION ------------------------------------------
+
+        MobilityHelper sensorMobility, intermediateMobility, serverMobility, gatewayMobility;
+
+        Ptr<ConstantPositionMobilityModel> gatewayMobilityModel = CreateObject<ConstantPositionMobilityModel>();
+        double xCoord = gatewayX;
+        double yCoord = gatewayY;
+        double zCoord = 0.0;
+        gatewayMobilityModel->SetPosition(ns3::Vector(xCoord, yCoord, zCoord));
+        gatewayNode.Get(0)->AggregateObject(gatewayMobilityModel);
+
+        for(uint32_t i = 0; i < serverShards; i++){ // servidores lado a lado, a 5 m um do outro
+            Ptr<ConstantPositionMobilityModel> serverMobilityModel = CreateObject<ConstantPositionMobilityModel>();
+            xCoord = serverX + 5.0 * i;
+            yCoord = serverY;
+            serverMobilityModel->SetPosition(ns3::Vector(xCoord, yCoord, zCoord));
+            serverNode.Get(i)->AggregateObject(serverMobilityModel);
+        }
 
-    Ptr<ConstantPositionMobilityModel> gatewayServerIntermediateMobilityModel = CreateObject<ConstantPositionMobilityModel>();
-    xCoord = 50.0;
-    yCoord = 50.0;
-    gatewayServerIntermediateMobilityModel->SetPosition(ns3::Vector(xCoord, yCoord, zCoord));
-    intermediateNodes.Get(0)->AggregateObject(gatewayServerIntermediateMobilityModel);
+        Ptr<ConstantPositionMobilityModel> gatewayServerIntermediateMobilityModel = CreateObject<ConstantPositionMobilityModel>();
+        xCoord = relayGX;
+        yCoord = relayGY;
+        gatewayServerIntermediateMobilityModel->SetPosition(ns3::Vector(xCoord, yCoord, zCoord));
+        intermediateNodes.Get(0)->AggregateObject(gatewayServerIntermediateMobilityModel);
+
+        Ptr<ConstantPositionMobilityModel> serverShelfIntermediateMobilityModel = CreateObject<ConstantPositionMobilityModel>();
+        xCoord = relaySX;
+        yCoord = relaySY;
+        serverShelfIntermediateMobilityModel->SetPosition(ns3::Vector(xCoord, yCoord, zCoord));
+        intermediateNodes.Get(1)->AggregateObject(serverShelfIntermediateMobilityModel);
+
+        std::vector<Ptr<ConstantPositionMobilityModel>> sensorMobilityModels;
+        xCoord = shelfX;
+        yCoord = shelfY;
+        uint shelfGroup = 1;
+
+        for(uint idx = 0; idx < sensorNodes.GetN(); idx++){
+            Ptr<ConstantPositionMobilityModel> sensorMobilityModel = CreateObject<ConstantPositionMobilityModel>();
+            sensorMobilityModels.push_back(sensorMobilityModel);
+            sensorMobilityModels[idx]->SetPosition(Vector(xCoord, yCoord, zCoord));
+            sensorNodes.Get(idx)->AggregateObject(sensorMobilityModels[idx]);
+
+            zCoord = shelfGroup%2==0 ? 0.0 : zCoord + shelfHeight ;
+            yCoord = shelfGroup%2==0 ? yCoord : yCoord - shelfSpacing;
+            shelfGroup = shelfGroup%2==0 ? 1 : shelfGroup + 1 ;
+        }
 
-    Ptr<ConstantPositionMobilityModel> serverShelfIntermediateMobilityModel = CreateObject<ConstantPositionMobilityModel>();
-    xCoord = 150.0;
-    yCoord = 100.0;
-    serverShelfIntermediateMobilityModel->SetPosition(ns3::Vector(xCoord, yCoord, zCoord));
-    intermediateNodes.Get(1)->AggregateObject(serverShelfIntermediateMobilityModel);
 
-    std::vector<Ptr<ConstantPositionMobilityModel>> sensorMobilityModels;
-    xCoord = 175.0;
-    yCoord = 125.0;
-    uint shelfGroup = 1;
+        //Install Internet Stacks on each node
+        InternetStackHelper stack;
+        stack.Install(serverNode);
+        stack.Install(intermediateNodes);
+        stack.Install(gatewayNode);
+        stack.Install(sensorNodes);
 
-    for(uint idx = 0; idx < sensorNodes.GetN(); idx++){
-        Ptr<ConstantPositionMobilityModel> sensorMobilityModel = CreateObject<ConstantPositionMobilityModel>();
-        sensorMobilityModels.push_back(sensorMobilityModel);
-        sensorMobilityModels[idx]->SetPosition(Vector(xCoord, yCoord, zCoord));
-        sensorNodes.Get(idx)->AggregateObject(sensorMobilityModels[idx]);
-    
-        zCoord = shelfGroup%2==0 ? 0.0 : zCoord + 10.0 ;
-        yCoord = shelfGroup%2==0 ? yCoord : yCoord - 25.0;
-        shelfGroup = shelfGroup%2==0 ? 1 : shelfGroup + 1 ;
+        // Plano de endereços: uma sub-rede por corredor para os sensores e uma por papel para os demais nós (ver AddressPlanner)
+        for(uint32_t aisle = 0; aisle < nAisles; aisle++){
+            NetDeviceContainer aisleDevices;
+            for(uint32_t i = aisle * shelvesPerAisle; i < std::min((aisle + 1) * shelvesPerAisle, nShelves); i++){
+                aisleDevices.Add(sensorDevices.Get(i));
+            }
+            sensorInterfaces.Add(planner.AssignAisle(aisleDevices, aisle));
+        }
+        intermediateInterfaces = planner.AssignInfrastructure(intermediateDevices, ROLE_RELAY);
+        serverInterface = planner.AssignInfrastructure(serverDevice, ROLE_SERVER);
+        gatewayInterface = planner.AssignInfrastructure(gatewayDevice, ROLE_GATEWAY);
+
+        // Todos os nós compartilham o mesmo canal: uma rota direta para o armazém inteiro em cada nó substitui
+        // o roteamento global, que calcularia uma rota por nó em cada um deles
+        planner.AddSiteRoutes(sensorInterfaces);
+        planner.AddSiteRoutes(intermediateInterfaces);
+        planner.AddSiteRoutes(serverInterface);
+        planner.AddSiteRoutes(gatewayInterface);
     }
-
-
-    //Install Internet Stacks on each node
-    InternetStackHelper stack;
-    stack.Install(serverNode);
-    stack.Install(intermediateNodes);
-    stack.Install(gatewayNode);
-    stack.Install(sensorNodes);
-
-    //Create an Address Helper
-
-    Ipv4AddressHelper address;
-    address.SetBase(SENSOR_ADDRESS, "255.255.255.0");
-    Ipv4InterfaceContainer sensorInterfaces = address.Assign(sensorDevices);
-
-    //address.SetBase(INTERMEDIATE_ADDRESS, "255.255.255.0");
-    Ipv4InterfaceContainer intermediateInterfaces = address.Assign(intermediateDevices);
-
-    //address.SetBase(SERVER_ADDRESS, "255.255.255.0");
-    Ipv4InterfaceContainer serverInterface = address.Assign(serverDevice);
-
-    //address.SetBase(GATEWAY_ADDRESS, "255.255.255.0");
-    Ipv4InterfaceContainer gatewayInterface = address.Assign(gatewayDevice);
-
-    ns3::Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+    // A largura do canal só pode ser configurada depois que os dispositivos existem; as células dos corredores já a
+    // recebem junto com o número do canal
+    if(topology != "aisles"){
+        Config::Set("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/ChannelWidth", UintegerValue(channelWidth));
+    }
+    if(errorRate > 0){ // perdas independentes em cada recepção, depois da decodificação pela PHY
+        Ptr<RateErrorModel> errorModel = CreateObject<RateErrorModel>();
+        errorModel->SetUnit(RateErrorModel::ERROR_UNIT_PACKET);
+        errorModel->SetRate(errorRate);
+        Config::Set("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PostReceptionErrorModel", PointerValue(errorModel));
+    }
+    std::cout << "Plano de endereços: " << nAisles << " corredores de até " << shelvesPerAisle << " prateleiras, "
+              << planner.GetSubnetCount() << " sub-redes em " << planner.GetSiteNetwork() << "/8" << std::endl;
 
     // Aplicação
     std::cout << "\n--------Aplicação--------\n" <<std::endl;
-    uint32_t port = 5500;
-    // Lógica para envio de dados
-    uint8_t* buffer = (uint8_t*)malloc(sizeof(messageData));
-    buffer[0] = 10;
-    buffer[1] = 11;
-    buffer[2] = 0;
-    buffer[3] = 0;
-
-    ns3::Ptr<ns3::Packet> packet = ns3::Create<ns3::Packet>(buffer, sizeof(messageData)); // Tamanho do pacote em bytes
-    Ptr<Socket> sensorSocket[sensorNodes.GetN()];
-
-    for (uint32_t i = 0; i < sensorNodes.GetN(); i++){
-        sensorSocket[i] = Socket::CreateSocket(sensorNodes.Get(i), TypeId::LookupByName("ns3::UdpSocketFactory"));
-        sensorSocket[i]->Bind(InetSocketAddress(sensorInterfaces.GetAddress(i), port));
+    // Servidores: cada um valida os comandos do gateway para as suas prateleiras, envia os aceitos em lotes aos sensores
+    // e confere os relatos dos sensores com a sua tabela. O primeiro inicia as verificações periódicas de todos os sensores.
+    std::vector<Ptr<WarehouseServerApplication>> serverApps;
+    for(uint32_t i = 0; i < serverShards; i++){
+        uint32_t firstShelf = i * nGroups / serverShards * 8 + 1;
+        uint32_t lastShelf = std::min((i + 1) * nGroups / serverShards * 8, nShelves);
+        Ptr<WarehouseServerApplication> serverApp = CreateObject<WarehouseServerApplication>();
+        serverApp->SetAttribute("Port", UintegerValue(port));
+        serverApp->SetAttribute("GatewayRelayAddress", Ipv4AddressValue(intermediateInterfaces.GetAddress(0)));
+        serverApp->SetAttribute("SensorRelayAddress", Ipv4AddressValue(intermediateInterfaces.GetAddress(1)));
+        serverApp->SetAttribute("PollPeriod", TimeValue(Seconds(i == 0 ? pollPeriod : 0)));
+        serverApp->SetAttribute("BatchWindow", TimeValue(Seconds(batchWindow)));
+        serverApp->SetAttribute("Coalesce", BooleanValue(coalesce));
+        serverApp->SetAttribute("Reliable", BooleanValue(reliable));
+        serverApp->SetInitialStates(server_state_table, firstShelf, lastShelf - firstShelf + 1);
+        serverApp->SetEventLog(&eventLog);
+        serverApp->SetMetrics(nodeMetrics);
+        serverApp->SetLatencyCollector(&latency);
+        serverNode.Get(i)->AddApplication(serverApp);
+        serverApp->SetStartTime(Seconds(0.0));
+        serverApp->SetStopTime(Seconds(stopTime));
+        serverApps.push_back(serverApp);
     }
 
-    // Server socket application
-    Ptr<Socket> serverSocket = Socket::CreateSocket(serverNode.Get(0), TypeId::LookupByName("ns3::UdpSocketFactory"));
-    serverSocket->Bind(InetSocketAddress(serverInterface.GetAddress(0), port));
-
-    // Intermediate socket applications
-    Ptr<Socket> intermediateSocketG = Socket::CreateSocket(intermediateNodes.Get(0), TypeId::LookupByName("ns3::UdpSocketFactory"));
-    intermediateSocketG->Bind(InetSocketAddress(intermediateInterfaces.GetAddress(0), port));
-
-    Ptr<Socket> intermediateSocketS = Socket::CreateSocket(intermediateNodes.Get(1), TypeId::LookupByName("ns3::UdpSocketFactory"));
-    intermediateSocketS->Bind(InetSocketAddress(intermediateInterfaces.GetAddress(1), port));
-
-    Ptr<Socket> gatewaySocket = Socket::CreateSocket(gatewayNode.Get(0), TypeId::LookupByName("ns3::UdpSocketFactory"));
-    gatewaySocket->Bind(InetSocketAddress(gatewayInterface.GetAddress(0), port));
-
-    // Intermediário entre server e gateway recebe a mensagem
-    intermediateSocketG->SetRecvCallback([&](Ptr<Socket> socket) {
-        ns3::Ptr<ns3::Packet> packetG;
-        ns3::Address from;
-        std::cout << "Here" << std::endl;
-        while ((packetG = socket->RecvFrom(from)))
-        {
-            uint32_t packetSize = packetG->GetSize();
-            ns3::Ipv4Address senderAddress = ns3::InetSocketAddress::ConvertFrom(from).GetIpv4();
-
-            // Lógica para processar o pacote recebido
-            // ...
-            uint8_t buffer[packetSize];
-            packetG->CopyData(buffer, packetSize);
-            messageData* data = (messageData*)malloc(sizeof(messageData));
-            data->source = buffer[0];
-            data->dest = buffer[1];
-            data->command = buffer[2];
-            data->payload = buffer[3];
-
-            switch (data->source)
-            {
-            case 10: // Veio do servidor
-                // Repassa mensagem recebida do servidor para o gateway.
-                intermediateSocketG->SendTo(packetG, 0, InetSocketAddress(gatewayInterface.GetAddress(0), port));
-                
-                break;
-            case 13: // Veio do gateway
-                // Repassa mensagem recebida do gateway para o servidor.
-                intermediateSocketG->SendTo(packetG, 0, InetSocketAddress(serverInterface.GetAddress(0), port));
-
-                break;
-            default: // Inconsistência na mensagem
-                uint8_t* errorMsg = (uint8_t*)malloc(sizeof(messageData));
-                errorMsg[0] = 11; // quem manda é o intermediário entre gateway e servidor
-                errorMsg[1] = data->source; // endereço de quem enviou a mensagem
-                errorMsg[2] = 5;  // codigo de mensagem de erro
-                errorMsg[3] = 0;  // codigo que indica que o erro foi de fonte não-suportada
-                packetG = Create<Packet>(errorMsg, sizeof(messageData)); // cria pacote com mensagem de erro
-                intermediateSocketG->SendTo(packetG, 0, InetSocketAddress(senderAddress, port)); // envia de volta para quem enviou a mensagem, indicando erro na comunicação
-                break;
-            }
-
-            std::cout << "Recebido pacote de " << senderAddress << ", tamanho: " << packetSize << " bytes" << std::endl;
-            std::cout << "src: " << data->source << ", dest: " << data->dest << ", command: " << data->command << ", payload" << data->payload << std::endl;
+    // Aplicação dos sensores, uma por prateleira
+    auto setupStart = std::chrono::steady_clock::now();
+    std::vector<Ptr<ShelfReadingSource>> readingSources;
+    for(uint32_t i = 0; i < nShelves; i++){
+        readingSources.push_back(Create<MappedReadingSource>(instance, i));
+    }
+    ShelfSensorHelper sensorHelper(intermediateInterfaces.GetAddress(1), port);
+    sensorHelper.SetAttribute("ReplyJitter", TimeValue(Seconds(replyJitter)));
+    sensorHelper.SetAttribute("DeltaReporting", BooleanValue(deltaReporting));
+    sensorHelper.SetAttribute("HeartbeatPolls", UintegerValue(heartbeatPolls));
+    sensorHelper.SetAttribute("Reliable", BooleanValue(reliable));
+    ApplicationContainer sensorApps = sensorHelper.Install(sensorNodes, readingSources, server_state_table);
+    for(uint32_t i = 0; i < sensorApps.GetN(); i++){
+        DynamicCast<ShelfSensorApplication>(sensorApps.Get(i))->SetMetrics(nodeMetrics);
+        DynamicCast<ShelfSensorApplication>(sensorApps.Get(i))->SetEventLog(&eventLog);
+        if(topology == "aisles"){ // cada sensor fala com o ponto de acesso do seu corredor
+            sensorApps.Get(i)->SetAttribute("RelayAddress", Ipv4AddressValue(aisleTopology.GetAccessPointAddress(aisleTopology.GetAisle(i))));
         }
-    });
-    intermediateSocketG->SetRecvPktInfo(true); // Enable receiving sender address information
-    // Intermediário entre sensores e server recebe a mensagem
-    intermediateSocketS->SetRecvCallback([&](Ptr<Socket> socket) {
-        ns3::Ptr<ns3::Packet> packetS;
-        ns3::Address from;
-        std::cout << "Here" << std::endl;
-        while ((packetS = socket->RecvFrom(from)))
-        {
-            uint32_t packetSize = packetS->GetSize();
-            ns3::Ipv4Address senderAddress = ns3::InetSocketAddress::ConvertFrom(from).GetIpv4();
-
-            // Lógica para processar o pacote recebido
-            // ...
-            uint8_t buffer[packetSize];
-            packetS->CopyData(buffer, packetSize);
-            messageData* data = (messageData*)malloc(sizeof(messageData));
-            data->source = buffer[0];
-            data->dest = buffer[1];
-            data->command = buffer[2];
-            data->payload = buffer[3];
-            uint8_t* errorMsg = (uint8_t*)malloc(sizeof(messageData));
-            uint8_t* msg = (uint8_t*)malloc(sizeof(messageData));
-
-            if(data->source == 10){ // Veio do servidor
-            // Repassa mensagem recebida do servidor para os sensores que a interessam.
-                switch (data->command)
-                {
-                    case 0: // servidor deseja descobrir estado atual dos sensores
-                        for(uint8_t i = 0; i < 6; i++){ // repassa a mensagem para cada um dos sensores solicitando seus valores atuais
-                            intermediateSocketS->SendTo(packetS, 0, InetSocketAddress(sensorInterfaces.GetAddress(i), port));
-                        }
-                        break;
-                    case 1: // servidor deseja esvaziar uma das prateleiras
-                        if(data->dest > 6 || data->dest < 0){ // caso o destino esteja fora do intervalo permitido, isto é, não seja o identificador de algum sensor
-                            errorMsg[0] = 12; // quem manda é o intermediário entre sensores e servidor
-                            errorMsg[1] = data->source;  // endereço de quem enviou a mensagem
-                            errorMsg[2] = 5;  // codigo de mensagem de erro
-                            errorMsg[3] = 1;  // codigo que indica que o erro foi de destino inválido
-                            packetS = Create<Packet>(errorMsg, sizeof(messageData)); // cria pacote com mensagem de erro
-                            intermediateSocketS->SendTo(packetS, 0, InetSocketAddress(senderAddress, port)); // envia de volta para quem enviou a mensagem, indicando erro na comunicação
-                        }else{
-                            intermediateSocketS->SendTo(packetS, 0, InetSocketAddress(sensorInterfaces.GetAddress(data->dest - 1), port)); // repassa a mensagem para o sensor a ser esvaziado
-                        }
-
-                        break;
-                    case 2: // servidor deseja preencher uma prateleira
-                        if(data->dest > 6 || data->dest < 0){ // caso o destino esteja fora do intervalo permitido, isto é, seja o identificador de algum sensor
-                            //uint8_t* errorMsg = (uint8_t*)malloc(sizeof(messageData));
-                            errorMsg[0] = 12; // quem manda é o intermediário entre sensores e servidor
-                            errorMsg[1] = data->source;  // endereço de quem enviou a mensagem
-                            errorMsg[2] = 5;  // codigo de mensagem de erro
-                            errorMsg[3] = 1;  // codigo que indica que o erro foi de destino inválido
-                            packetS = Create<Packet>(errorMsg, sizeof(messageData)); // cria pacote com mensagem de erro
-                            intermediateSocketS->SendTo(packetS, 0, InetSocketAddress(senderAddress, port)); // envia de volta para quem enviou a mensagem, indicando erro na comunicação
-                            
-                            break;
-                        }
-                        msg[0] = data->source; // A fonte da mensagem permanece inalterada
-                        msg[1] = data->dest;  // endereço da prateleira que deve ser preenchida
-                        msg[2] = data->command;  // codigo de mensagem de preenchimento de prateleira
-                        msg[3] = 0;  // não importa, deixo em 0.
-                        packetS = Create<Packet>(msg, sizeof(messageData)); // cria pacote com mensagem a ser repassada
-                        intermediateSocketS->SendTo(packetS, 0, InetSocketAddress(sensorInterfaces.GetAddress(data->dest - 1), port)); // repassa a mensagem para o sensor a ser preenchido
-
-                        break;
-                    case 5: // Ocorreu Erro
-                        break;
-                    default: // instrução inválida, envia mensagem de erro de volta para o nó que enviou a mensagem original.
-                        //uint8_t* errorMsg = (uint8_t*)malloc(sizeof(messageData));
-                        errorMsg[0] = 12; // quem manda é o intermediário entre sensores e servidor
-                        errorMsg[1] = data->source;  // endereço de quem enviou a mensagem
-                        errorMsg[2] = 5;  // codigo de mensagem de erro
-                        errorMsg[3] = 2;  // codigo que indica que o erro foi de comando inválido
-                        packetS = Create<Packet>(errorMsg, sizeof(messageData)); // cria pacote com mensagem de erro
-                        intermediateSocketS->SendTo(packetS, 0, InetSocketAddress(senderAddress, port)); // envia de volta para quem enviou a mensagem, indicando erro na comunicação
-
-                        break;
-                }
-            } else {
-                if(data->source > 0 && data->source <= 6){ // é algum dos sensores
-                    intermediateSocketS->SendTo(packetS, 0, InetSocketAddress(serverInterface.GetAddress(0), port)); // repassa a mensagem para o servidor
-                } else { // Inconsistência na mensagem
-                       // uint8_t* errorMsg = (uint8_t*)malloc(sizeof(messageData));
-                        errorMsg[0] = 12; // quem manda é o intermediário entre sensores e servidor
-                        errorMsg[1] = data->source; // endereço de quem enviou a mensagem
-                        errorMsg[2] = 5;  // codigo de mensagem de erro
-                        errorMsg[3] = 0;  // codigo que indica que o erro foi de fonte inválida
-                        packetS = Create<Packet>(errorMsg, sizeof(messageData)); // cria pacote com mensagem de erro
-                        intermediateSocketS->SendTo(packetS, 0, InetSocketAddress(senderAddress, port)); // envia de volta para quem enviou a mensagem, indicando erro na comunicação
-                    }
-
-                }
-
-            std::cout << "Recebido pacote de " << senderAddress << ", tamanho: " << packetSize << " bytes" << std::endl;
-            std::cout << "src: " << data->source << ", dest: " << data->dest << ", command: " << data->command << ", payload" << data->payload << std::endl;
+    }
+    sensorApps.Start(Seconds(0.0));
+    sensorApps.Stop(Seconds(stopTime));
+    auto setupEnd = std::chrono::steady_clock::now();
+    std::cout << "Sensores instalados: " << nShelves << " em " << std::chrono::duration<double, std::milli>(setupEnd - setupStart).count() << " ms" << std::endl;
+
+    // Intermediários: rotas e tratadores de comando montados uma única vez
+    // Intermediário entre servidor e gateway: tudo que vem do servidor segue para o gateway
+    Ptr<WarehouseRelayApplication> gatewayRelay = CreateObject<WarehouseRelayApplication>();
+    gatewayRelay->SetAttribute("NodeId", UintegerValue(GATEWAY_RELAY_ID));
+    gatewayRelay->SetAttribute("UplinkAddress", Ipv4AddressValue(serverInterface.GetAddress(0)));
+    gatewayRelay->SetAttribute("Port", UintegerValue(port));
+    gatewayRelay->SetAttribute("ShardBy", EnumValue(WarehouseRelayApplication::SHARD_BY_PAYLOAD)); // o alvo do comando escolhe o servidor
+    gatewayRelay->AddRoute(GATEWAY_ID, gatewayInterface.GetAddress(0));
+    gatewayRelay->SetDefaultHandler(MakeCallback(&WarehouseRelayApplication::ForwardToAll, PeekPointer(gatewayRelay)));
+    gatewayRelay->SetAttribute("Reliable", BooleanValue(reliable));
+    gatewayRelay->SetEventLog(&eventLog);
+    gatewayRelay->SetMetrics(nodeMetrics);
+    intermediateNodes.Get(0)->AddApplication(gatewayRelay);
+
+    // Intermediário entre sensores e servidor: verificação vai para todos os sensores, esvaziar e preencher para o sensor de destino.
+    // Na topologia de corredores, o mesmo papel é feito pelo intermediário no ponto de acesso de cada corredor, para os sensores
+    // da sua célula, e o intermediário dos sensores passa a repassar a verificação a cada ponto de acesso.
+    auto setSensorHandlers = [&](Ptr<WarehouseRelayApplication> relay, bool broadcast){
+        if(broadcast){ // um único quadro em difusão alcança todos os sensores
+            relay->SetCommandHandler(COMMAND_VERIFY, MakeCallback(&WarehouseRelayApplication::Broadcast, PeekPointer(relay)));
+        }else{
+            relay->SetCommandHandler(COMMAND_VERIFY, MakeCallback(&WarehouseRelayApplication::ForwardToAll, PeekPointer(relay)));
         }
-    });
-    intermediateSocketS->SetRecvPktInfo(true); // Enable receiving sender address information
-
-    serverSocket->SetRecvCallback([&](Ptr<Socket> socket){
-        ns3::Ptr<ns3::Packet> packetServer;
-        ns3::Address from;
-        std::cout << "Here" << std::endl;
-        while ((packetServer = socket->RecvFrom(from)))
-        {
-            uint32_t packetSize = packetServer->GetSize();
-            ns3::Ipv4Address senderAddress = ns3::InetSocketAddress::ConvertFrom(from).GetIpv4();
-
-            // Lógica para processar o pacote recebido
-            // ...
-            uint8_t buffer[packetSize];
-            packetServer->CopyData(buffer, packetSize);
-            messageData* data = (messageData*)malloc(sizeof(messageData));
-            data->source = buffer[0];
-            data->dest = buffer[1];
-            data->command = buffer[2];
-            data->payload = buffer[3];
-
-            if(data->source == 13){ // Fonte é o gateway
-
-                uint8_t* errorMsg = (uint8_t*)malloc(sizeof(messageData));
-                uint8_t* msg = (uint8_t*)malloc(sizeof(messageData));
-                switch (data->command)
-                {
-                case 0: // Comando recebido é não fazer nada.
-                    break;
-                case 1: // Comando recebido é esvaziar uma prateleira
-                    if(data->payload > 6 || data->payload < 0){ // caso o payload esteja fora do intervalo permitido, isto é, não seja o identificador de alguma prateleira
-                        errorMsg[0] = 10; // quem manda é o servidor
-                        errorMsg[1] = 13; // endereço de gateway
-                        errorMsg[2] = 5;  // codigo de mensagem de erro
-                        errorMsg[3] = 1;  // codigo que indica que o erro foi de destino inválido
-                        packetServer = Create<Packet>(errorMsg, sizeof(messageData)); // cria pacote com mensagem de erro
-                        serverSocket->SendTo(packetServer, 0, InetSocketAddress(senderAddress, port)); // envia de volta para o nó intermediário entre servidor e gateway, indicando que sua solicitação foi inválida
-
-                    } else { // Caso o payload esteja no intervalo permitido
-                        bool current_state = server_state_table[data->payload - 1];
-                        if(current_state){ // Se a prateleira estiver cheia, mensagem alcançou seu destino, agora o servidor deve atualizar sua tabela de estados e solicitar a mudança no estado da prateleira
-                            server_state_table[data->payload - 1] = false; // Atualiza a tabela do servidor para o novo estado da prateleira a ser esvaziada
-                            msg[0] = 10; // A nova mensagem tem como fonte o servidor
-                            msg[1] = data->payload;  // endereço da prateleira que deve ser esvaziada
-                            msg[2] = data->command;  // codigo de mensagem de esvaziamento de prateleira
-                            msg[3] = 0;  // não importa, deixo em 0.
-                            packetServer = Create<Packet>(msg, sizeof(messageData)); // cria pacote com mensagem a ser repassada
-                            serverSocket->SendTo(packetServer, 0, InetSocketAddress(intermediateInterfaces.GetAddress(1), port)); // repassa a mensagem para o nó intermediário entre servidor e sensor
-
-                        } else { // Se a prateleira estiver vazia, envia mensagem de erro, indicando que a solicitação do gateway é inválida
-                            errorMsg[0] = 10; // quem manda é o servidor
-                            errorMsg[1] = 13; // endereço de gateway
-                            errorMsg[2] = 5;  // codigo de mensagem de erro
-                            errorMsg[3] = 3;  // codigo que indica que o erro foi de tentativa de esvaziamento de prateleira vazia
-                            packetServer = Create<Packet>(errorMsg, sizeof(messageData)); // cria pacote com mensagem de erro
-                            serverSocket->SendTo(packetServer, 0, InetSocketAddress(senderAddress, port)); // envia de volta parao nó intermediário entre servidor e gateway, indicando que sua solicitação foi inválida
-                        }
-                    }
-                    break;
-                case 2: // Comando recebido é preencher uma prateleira
-                    if(data->payload > 6 || data->payload < 0){ // caso o payload esteja fora do intervalo permitido, isto é, não seja o identificador de alguma prateleira
-                        errorMsg[0] = 10; // quem manda é o servidor
-                        errorMsg[1] = 13; // endereço de gateway
-                        errorMsg[2] = 5;  // codigo de mensagem de erro
-                        errorMsg[3] = 1;  // codigo que indica que o erro foi de destino inválido
-                        packetServer = Create<Packet>(errorMsg, sizeof(messageData)); // cria pacote com mensagem de erro
-                        serverSocket->SendTo(packetServer, 0, InetSocketAddress(senderAddress, port)); // envia de volta para o nó intermediário entre servidor e gateway, indicando que sua solicitação foi inválida
-
-                    } else { // Caso o payload esteja no intervalo permitido
-                        bool current_state = server_state_table[data->payload - 1];
-                        if(!current_state){ // Se a prateleira estiver vazia, mensagem alcançou seu destino, agora o servidor deve atualizar sua tabela de estados e solicitar a mudança no estado da prateleira
-                            server_state_table[data->payload - 1] = true; // Atualiza a tabela do servidor para o novo estado da prateleira a ser preenchida
-                            msg[0] = 10; // A nova mensagem tem como fonte o servidor
-                            msg[1] = data->payload;  // endereço da prateleira que deve ser preenchida
-                            msg[2] = data->command;  // codigo de mensagem de preenchimento de prateleira
-                            msg[3] = 0;  // não importa, deixo em 0.
-                            packetServer = Create<Packet>(msg, sizeof(messageData)); // cria pacote com mensagem a ser repassada
-                            serverSocket->SendTo(packetServer, 0, InetSocketAddress(intermediateInterfaces.GetAddress(1), port)); // repassa a mensagem para o nó intermediário entre servidor e sensores
-
-                        } else { // Se a prateleira estiver cheia, envia mensagem de erro, indicando que a solicitação do gateway é inválida
-                            errorMsg[0] = 10; // quem manda é o servidor
-                            errorMsg[1] = 13; // endereço de gateway
-                            errorMsg[2] = 5;  // codigo de mensagem de erro
-                            errorMsg[3] = 4;  // codigo que indica que o erro foi de tentativa de preenchimento de prateleira cheia
-                            packetServer = Create<Packet>(errorMsg, sizeof(messageData)); // cria pacote com mensagem de erro
-                            serverSocket->SendTo(packetServer, 0, InetSocketAddress(senderAddress, port)); // envia de volta para o nó intermediário entre servidor e gateway, indicando que sua solicitação foi inválida
-                        }
-                    }
-
-                    break;
-                default:
-                    NS_LOG_INFO("Comando inválido");
-                    break;
-                }
-            } else if(data->source > 0 && data->source <= 6){ // Fonte é um dos sensores
-                if(data->payload != server_state_table[data->source - 1]){ // Caso ocorra inconsistência entre a tabela do servidor e os dados enviados pelo sensor
-                    server_state_table[data->source - 1] = !server_state_table[data->source - 1]; // Atualiza a tabela do servidor
-                    NS_LOG_INFO("Discrepância entre leitura esperada e real dos sensores, enviando mensagem de erro para Gateway.");
-                    uint8_t* errorMsg = (uint8_t*)malloc(sizeof(messageData));
-                            errorMsg[0] = 10; // quem manda é o servidor
-                            errorMsg[1] = 13; // endereço de gateway
-                            errorMsg[2] = 5;  // codigo de mensagem de erro
-                            errorMsg[3] = 5;  // codigo que indica que o erro foi de tentativa de inconsistência de valores.
-                            packetServer = Create<Packet>(errorMsg, sizeof(messageData)); // cria pacote com mensagem de erro
-                            serverSocket->SendTo(packetServer, 0, InetSocketAddress(intermediateInterfaces.GetAddress(0), port)); // envia de volta para o nó intermediário entre servidor e gateway, indicando que ocorreu erro
-                }else{ // Caso o payload seja consistente com a tabela do servidor
-                    uint8_t* msg = (uint8_t*)malloc(sizeof(messageData));
-                    if(data->command == 1 || data->command == 2){ // Se o comando vier do gateway(1 ou 2), responde a ele com mensagem de sucesso.
-                        msg[0] = 10; // A nova mensagem tem como fonte o servidor
-                        msg[1] = data->payload;  // endereço da prateleira que deve ser preenchida
-                        msg[2] = data->command;  // codigo de mensagem de preenchimento de prateleira
-                        msg[3] = 0;  // não importa, deixo em 0.
-                        packetServer = Create<Packet>(msg, sizeof(messageData)); // cria pacote com mensagem a ser repassada
-                        serverSocket->SendTo(packetServer, 0, InetSocketAddress(intermediateInterfaces.GetAddress(0), port)); // repassa a mensagem de sucesso para o nó intermediário entre servidor e gateway
-                    }else{ // caso o comando seja 0(verificar estado dos sensores), não é necessário mandar nenhuma mensagem, visto que ele partiu do proprio servidor
-                        NS_LOG_INFO("Verificação do estado dos sensores concluida com sucesso.");
-                    }
-                }
-
-            } else if(data->source == 11 || data->source == 12){ // Fonte é um dos nós intermediários, indicando que houve erro
-                NS_LOG_INFO("Erro No envio para Nó intermediário. Dados inválidos ou corrompidos.");
-
-            } else { // Fonte inválida
-                NS_LOG_INFO("Identificador Fonte Inválido, finalizando comunicação.");
+        relay->SetCommandHandler(COMMAND_EMPTY, MakeCallback(&WarehouseRelayApplication::ForwardToDest, PeekPointer(relay)));
+        relay->SetCommandHandler(COMMAND_FILL, MakeCallback(&WarehouseRelayApplication::ForwardToDest, PeekPointer(relay)));
+        relay->SetCommandHandler(COMMAND_ERROR, MakeCallback(&WarehouseRelayApplication::Drop, PeekPointer(relay)));
+        relay->SetAttribute("Port", UintegerValue(port));
+        relay->SetAttribute("Reliable", BooleanValue(reliable));
+        relay->SetEventLog(&eventLog);
+        relay->SetMetrics(nodeMetrics);
+    };
+    Ptr<WarehouseRelayApplication> sensorRelay = CreateObject<WarehouseRelayApplication>();
+    sensorRelay->SetAttribute("NodeId", UintegerValue(SENSOR_RELAY_ID));
+    sensorRelay->SetAttribute("UplinkAddress", Ipv4AddressValue(serverInterface.GetAddress(0)));
+    sensorRelay->SetAttribute("ShardBy", EnumValue(WarehouseRelayApplication::SHARD_BY_SOURCE));
+    ApplicationContainer aisleRelayApps;
+    if(topology == "aisles"){
+        setSensorHandlers(sensorRelay, false);
+        for(uint32_t aisle = 0; aisle < aisleTopology.GetAisleCount(); aisle++){
+            uint32_t aisleRelayId = MakeNodeId(ROLE_RELAY, 2 + aisle);
+            Ipv4Address accessPoint = aisleTopology.GetAccessPointUplinkAddress(aisle);
+            Ptr<WarehouseRelayApplication> aisleRelay = CreateObject<WarehouseRelayApplication>();
+            aisleRelay->SetAttribute("NodeId", UintegerValue(aisleRelayId));
+            aisleRelay->SetAttribute("UplinkAddress", Ipv4AddressValue(aisleTopology.GetCoreAddress(aisle)));
+            aisleRelay->SetAttribute("AggregationWindow", TimeValue(Seconds(aggregationWindow)));
+            setSensorHandlers(aisleRelay, verifyMode == "broadcast");
+            for(uint32_t i = aisle * shelvesPerAisle; i < std::min((aisle + 1) * shelvesPerAisle, nShelves); i++){
+                aisleRelay->AddRoute(i + 1, sensorInterfaces.GetAddress(i)); // sensor i + 1
+                sensorRelay->AddRoute(i + 1, accessPoint);
             }
-
-            std::cout << "Recebido pacote de " << senderAddress << ", tamanho: " << packetSize << " bytes" << std::endl;
-            std::cout << "src: " << data->source << ", dest: " << data->dest << ", command: " << data->command << ", payload" << data->payload << std::endl;
+            sensorRelay->AddRoute(aisleRelayId, accessPoint); // relatórios agregados do corredor
+            aisleTopology.GetAccessPoints().Get(aisle)->AddApplication(aisleRelay);
+            aisleRelayApps.Add(aisleRelay);
         }
-    });
-    serverSocket->SetRecvPktInfo(true); // Enable receiving sender address information
-
-    sensorSocket[0]->SetRecvCallback([&](Ptr<Socket>socket){
-        ns3::Ptr<ns3::Packet> packetSensor;
-        ns3::Address from;
-        std::cout << "Here" << std::endl;
-        while ((packetSensor = socket->RecvFrom(from)))
-        {
-            uint32_t packetSize = packetSensor->GetSize();
-            ns3::Ipv4Address senderAddress = ns3::InetSocketAddress::ConvertFrom(from).GetIpv4();
-
-            // Lógica para processar o pacote recebido
-            // ...
-            uint8_t buffer[packetSize];
-            packetSensor->CopyData(buffer, packetSize);
-            messageData* data = (messageData*)malloc(sizeof(messageData));
-            data->source = buffer[0];
-            data->dest = buffer[1];
-            data->command = buffer[2];
-            data->payload = buffer[3];
-            
-            uint8_t* msg = (uint8_t*)malloc(sizeof(messageData));
-
-            switch (data->command)
-            {
-            case 0: // Verificar estado dos sensores
-            if(shelf1.size() > 0){ // Verifica se a fila não está vazia
-                    sensor_state_vector[0] = shelf1.front(); // Lê do vetor do log das leituras do sensor da prateleira 1 o próximo valor e atualiza a tabela de sensores.
-                    shelf1.pop(); // elimina o valor da fila.
-                    msg[0] = 1; // A nova mensagem tem como fonte o sensor da prateleira 1
-                    msg[1] = 10;  // Identificador do servidor
-                    msg[2] = data->command;  // codigo de mensagem de verificação de estado da prateleira
-                    msg[3] = sensor_state_vector[0];  // Payload assume o valor da leitura do sensor
-                    packetSensor = Create<Packet>(msg, sizeof(messageData)); // cria pacote com mensagem a ser repassada
-                    sensorSocket[0]->SendTo(packetSensor, 0, InetSocketAddress(intermediateInterfaces.GetAddress(1), port)); // repassa a mensagem para o nó intermediário entre servidor e sensores
-
-                } else { // caso esteja vazia, avisa que não há mais leituras do sensor
-                    NS_LOG_INFO("Log esvaziado. Não Há mais leituras do sensor da prateleira 1.");
-                }
-                
-                break;
-            case 1: // Esvaziar prateleria
-            if(shelf1.size() > 0){ // Verifica se a fila não está vazia
-                    sensor_state_vector[0] = false; //Esvazia a prateleira.
-                    msg[0] = 1; // A nova mensagem tem como fonte o sensor da prateleira 1
-                    msg[1] = 10;  // Identificador do servidor
-                    msg[2] = data->command;  // codigo de mensagem de verificação de estado da prateleira
-                    msg[3] = false;  // Payload assume o valor 0, indicando que a prateleira foi esvaziada
-                    packetSensor = Create<Packet>(msg, sizeof(messageData)); // cria pacote com mensagem a ser repassada
-                    sensorSocket[0]->SendTo(packetSensor, 0, InetSocketAddress(intermediateInterfaces.GetAddress(1), port)); // repassa a mensagem para o nó intermediário entre servidor e sensores
-
-                } else { // caso esteja vazia, avisa que não há mais leituras do sensor
-                    NS_LOG_INFO("Log esvaziado. Não Há mais leituras do sensor da prateleira 1.");
-                }
-
-                break;
-            case 2: // Preencher prateleira
-                    sensor_state_vector[0] = true; //Preenche a prateleira.
-                    msg[0] = 1; // A nova mensagem tem como fonte o sensor da prateleira 1
-                    msg[1] = 10;  // Identificador do servidor
-                    msg[2] = data->command;  // codigo de mensagem de verificação de estado da prateleira
-                    msg[3] = true;  // Payload assume o valor 0, indicando que a prateleira foi preenchida
-                    packetSensor = Create<Packet>(msg, sizeof(messageData)); // cria pacote com mensagem a ser repassada
-                    sensorSocket[0]->SendTo(packetSensor, 0, InetSocketAddress(intermediateInterfaces.GetAddress(1), port)); // repassa a mensagem para o nó intermediário entre servidor e sensores
-                break;
-            default: // Inconsistência na mensagem(Não deve entrar aqui)
-                NS_LOG_INFO("O sensor não consegue processar o comando enviado.");
-                break;
-            }
-
-            std::cout << "Recebido pacote de " << senderAddress << ", tamanho: " << packetSize << " bytes" << std::endl;
-            std::cout << "src: " << data->source << ", dest: " << data->dest << ", command: " << data->command << ", payload" << data->payload << std::endl;
+    }else{
+        for(uint32_t i = 0; i < nShelves; i++){
+            sensorRelay->AddRoute(i + 1, sensorInterfaces.GetAddress(i)); // sensor i + 1
         }
-    });
-    sensorSocket[0]->SetRecvPktInfo(true); // Enable receiving sender address information
-
-    sensorSocket[1]->SetRecvCallback([&](Ptr<Socket>socket){
-        ns3::Ptr<ns3::Packet> packetSensor;
-        ns3::Address from;
-        std::cout << "Here" << std::endl;
-        while ((packetSensor = socket->RecvFrom(from)))
-        {
-            uint32_t packetSize = packetSensor->GetSize();
-            ns3::Ipv4Address senderAddress = ns3::InetSocketAddress::ConvertFrom(from).GetIpv4();
-
-            // Lógica para processar o pacote recebido
-            // ...
-            uint8_t buffer[packetSize];
-            packetSensor->CopyData(buffer, packetSize);
-            messageData* data = (messageData*)malloc(sizeof(messageData));
-            data->source = buffer[0];
-            data->dest = buffer[1];
-            data->command = buffer[2];
-            data->payload = buffer[3];
-            
-            uint8_t* msg = (uint8_t*)malloc(sizeof(messageData));
-
-            switch (data->command)
-            {
-            case 0: // Verificar estado dos sensores
-            if(shelf2.size() > 0){ // Verifica se a fila não está vazia
-                    sensor_state_vector[0] = shelf2.front(); // Lê do vetor do log das leituras do sensor da prateleira 1 o próximo valor e atualiza a tabela de sensores.
-                    shelf2.pop(); // elimina o valor da fila.
-                    msg[0] = 2; // A nova mensagem tem como fonte o sensor da prateleira 2
-                    msg[1] = 10;  // Identificador do servidor
-                    msg[2] = data->command;  // codigo de mensagem de verificação de estado da prateleira
-                    msg[3] = sensor_state_vector[1];  // Payload assume o valor da leitura do sensor
-                    packetSensor = Create<Packet>(msg, sizeof(messageData)); // cria pacote com mensagem a ser repassada
-                    sensorSocket[1]->SendTo(packetSensor, 0, InetSocketAddress(intermediateInterfaces.GetAddress(1), port)); // repassa a mensagem para o nó intermediário entre servidor e sensores
-
-                } else { // caso esteja vazia, avisa que não há mais leituras do sensor
-                    NS_LOG_INFO("Log esvaziado. Não Há mais leituras do sensor da prateleira 2.");
-                }
-                
-                break;
-            case 1: // Esvaziar prateleria
-            if(shelf2.size() > 0){ // Verifica se a fila não está vazia
-                    sensor_state_vector[1] = false; //Esvazia a prateleira.
-                    msg[0] = 2; // A nova mensagem tem como fonte o sensor da prateleira 2
-                    msg[1] = 10;  // Identificador do servidor
-                    msg[2] = data->command;  // codigo de mensagem de verificação de estado da prateleira
-                    msg[3] = false;  // Payload assume o valor 0, indicando que a prateleira foi esvaziada
-                    packetSensor = Create<Packet>(msg, sizeof(messageData)); // cria pacote com mensagem a ser repassada
-                    sensorSocket[1]->SendTo(packetSensor, 0, InetSocketAddress(intermediateInterfaces.GetAddress(1), port)); // repassa a mensagem para o nó intermediário entre servidor e sensores
-
-                } else { // caso esteja vazia, avisa que não há mais leituras do sensor
-                    NS_LOG_INFO("Log esvaziado. Não Há mais leituras do sensor da prateleira 2.");
-                }
-
-                break;
-            case 2: // Preencher prateleira
-                if(shelf2.size() > 0){
-                    sensor_state_vector[1] = true; //Preenche a prateleira.
-                    msg[0] = 2; // A nova mensagem tem como fonte o sensor da prateleira 2
-                    msg[1] = 10;  // Identificador do servidor
-                    msg[2] = data->command;  // codigo de mensagem de verificação de estado da prateleira
-                    msg[3] = true;  // Payload assume o valor 0, indicando que a prateleira foi preenchida
-                    packetSensor = Create<Packet>(msg, sizeof(messageData)); // cria pacote com mensagem a ser repassada
-                    sensorSocket[1]->SendTo(packetSensor, 0, InetSocketAddress(intermediateInterfaces.GetAddress(1), port)); // repassa a mensagem para o nó intermediário entre servidor e sensores
-                } else { // caso esteja vazia, avisa que não há mais leituras do sensor
-                    NS_LOG_INFO("Log esvaziado. Não Há mais leituras do sensor da prateleira 2.");
-                }
-                break;
-            default: // Inconsistência na mensagem(Não deve entrar aqui)
-                NS_LOG_INFO("O sensor não consegue processar o comando enviado.");
-                break;
-            }
-
-            std::cout << "Recebido pacote de " << senderAddress << ", tamanho: " << packetSize << " bytes" << std::endl;
-            std::cout << "src: " << data->source << ", dest: " << data->dest << ", command: " << data->command << ", payload" << data->payload << std::endl;
+        sensorRelay->SetAttribute("AggregationWindow", TimeValue(Seconds(aggregationWindow)));
+        setSensorHandlers(sensorRelay, verifyMode == "broadcast");
+        for(uint32_t aisle = 0; aisle < nAisles; aisle++){ // o intermediário está na sub-rede da infraestrutura, não na dos sensores
+            sensorRelay->AddBroadcastAddress(planner.GetSubnetBroadcast(aisle, ROLE_SHELF));
         }
-    });
-    sensorSocket[1]->SetRecvPktInfo(true); // Enable receiving sender address information
-
-    sensorSocket[2]->SetRecvCallback([&](Ptr<Socket>socket){
-        ns3::Ptr<ns3::Packet> packetSensor;
-        ns3::Address from;
-        std::cout << "Here" << std::endl;
-        while ((packetSensor = socket->RecvFrom(from)))
-        {
-            uint32_t packetSize = packetSensor->GetSize();
-            ns3::Ipv4Address senderAddress = ns3::InetSocketAddress::ConvertFrom(from).GetIpv4();
-
-            // Lógica para processar o pacote recebido
-            // ...
-            uint8_t buffer[packetSize];
-            packetSensor->CopyData(buffer, packetSize);
-            messageData* data = (messageData*)malloc(sizeof(messageData));
-            data->source = buffer[0];
-            data->dest = buffer[1];
-            data->command = buffer[2];
-            data->payload = buffer[3];
-            
-            uint8_t* msg = (uint8_t*)malloc(sizeof(messageData));
-
-            switch (data->command)
-            {
-            case 0: // Verificar estado dos sensores
-            if(shelf3.size() > 0){ // Verifica se a fila não está vazia
-                    sensor_state_vector[2] = shelf3.front(); // Lê do vetor do log das leituras do sensor da prateleira 1 o próximo valor e atualiza a tabela de sensores.
-                    shelf3.pop(); // elimina o valor da fila.
-                    msg[0] = 3; // A nova mensagem tem como fonte o sensor da prateleira 3
-                    msg[1] = 10;  // Identificador do servidor
-                    msg[2] = data->command;  // codigo de mensagem de verificação de estado da prateleira
-                    msg[3] = sensor_state_vector[2];  // Payload assume o valor da leitura do sensor
-                    packetSensor = Create<Packet>(msg, sizeof(messageData)); // cria pacote com mensagem a ser repassada
-                    sensorSocket[1]->SendTo(packetSensor, 0, InetSocketAddress(intermediateInterfaces.GetAddress(1), port)); // repassa a mensagem para o nó intermediário entre servidor e sensores
-
-                } else { // caso esteja vazia, avisa que não há mais leituras do sensor
-                    NS_LOG_INFO("Log esvaziado. Não Há mais leituras do sensor da prateleira 3.");
-                }
-                
-                break;
-            case 1: // Esvaziar prateleria
-            if(shelf3.size() > 0){ // Verifica se a fila não está vazia
-                    sensor_state_vector[2] = false; //Esvazia a prateleira.
-                    msg[0] = 3; // A nova mensagem tem como fonte o sensor da prateleira 3
-                    msg[1] = 10;  // Identificador do servidor
-                    msg[2] = data->command;  // codigo de mensagem de verificação de estado da prateleira
-                    msg[3] = false;  // Payload assume o valor 0, indicando que a prateleira foi esvaziada
-                    packetSensor = Create<Packet>(msg, sizeof(messageData)); // cria pacote com mensagem a ser repassada
-                    sensorSocket[1]->SendTo(packetSensor, 0, InetSocketAddress(intermediateInterfaces.GetAddress(1), port)); // repassa a mensagem para o nó intermediário entre servidor e sensores
+    }
+    intermediateNodes.Get(1)->AddApplication(sensorRelay);
 
-                } else { // caso esteja vazia, avisa que não há mais leituras do sensor
-                    NS_LOG_INFO("Log esvaziado. Não Há mais leituras do sensor da prateleira 1.");
-                }
+    for(uint32_t i = 0; i < serverShards; i++){ // registros sobre prateleiras de outro servidor não passam pelo primeiro
+        uint32_t firstShelf = serverApps[i]->GetFirstShelf();
+        uint32_t lastShelf = firstShelf + serverApps[i]->GetShelfCount() - 1;
+        gatewayRelay->AddShard(firstShelf, lastShelf, serverInterface.GetAddress(i));
+        sensorRelay->AddShard(firstShelf, lastShelf, serverInterface.GetAddress(i));
+    }
 
-                break;
-            case 2: // Preencher prateleira
-            if(shelf3.size() > 0){// Verifica se a fila não está vazia
-                    sensor_state_vector[2] = true; //Preenche a prateleira.
-                    msg[0] = 3; // A nova mensagem tem como fonte o sensor da prateleira 3
-                    msg[1] = 10;  // Identificador do servidor
-                    msg[2] = data->command;  // codigo de mensagem de verificação de estado da prateleira
-                    msg[3] = true;  // Payload assume o valor 0, indicando que a prateleira foi preenchida
-                    packetSensor = Create<Packet>(msg, sizeof(messageData)); // cria pacote com mensagem a ser repassada
-                    sensorSocket[1]->SendTo(packetSensor, 0, InetSocketAddress(intermediateInterfaces.GetAddress(1), port)); // repassa a mensagem para o nó intermediário entre servidor e sensores
-                }
-                break;
-            default: // Inconsistência na mensagem(Não deve entrar aqui)
-                NS_LOG_INFO("O sensor não consegue processar o comando enviado.");
-                break;
+    ApplicationContainer relayApps(gatewayRelay);
+    relayApps.Add(sensorRelay);
+    relayApps.Add(aisleRelayApps);
+    relayApps.Start(Seconds(0.0));
+    relayApps.Stop(Seconds(stopTime));
+
+    // Gateway: comandos da instância em ritmo fixo ou em uma janela de comandos pendentes, ou carga em malha aberta
+    Ptr<GatewayClientApplication> gatewayApp;
+    if(load == "instance"){
+        gatewayApp = CreateObject<GatewayClientApplication>();
+        gatewayApp->SetCommandSource(Create<InstanceCommandSource>(gateway_commands, gateway_target));
+    }else{
+        Ptr<GatewayLoadGenerator> generator = CreateObject<GatewayLoadGenerator>();
+        if(load == "trace"){
+            Ptr<TraceCommandSource> trace = Create<TraceCommandSource>();
+            if(!trace->Load(loadTrace)){
+                std::cout << "Erro ao ler o trace de comandos " << loadTrace << ". Detalhes: " << trace->GetError() << std::endl;
+                return 1;
             }
-
-            std::cout << "Recebido pacote de " << senderAddress << ", tamanho: " << packetSize << " bytes" << std::endl;
-            std::cout << "src: " << data->source << ", dest: " << data->dest << ", command: " << data->command << ", payload" << data->payload << std::endl;
+            generator->SetTrace(trace);
         }
-    });
-    sensorSocket[2]->SetRecvPktInfo(true); // Enable receiving sender address information
-
-    sensorSocket[3]->SetRecvCallback([&](Ptr<Socket>socket){
-        ns3::Ptr<ns3::Packet> packetSensor;
-        ns3::Address from;
-        std::cout << "Here" << std::endl;
-        while ((packetSensor = socket->RecvFrom(from)))
-        {
-            uint32_t packetSize = packetSensor->GetSize();
-            ns3::Ipv4Address senderAddress = ns3::InetSocketAddress::ConvertFrom(from).GetIpv4();
-
-            // Lógica para processar o pacote recebido
-            // ...
-            uint8_t buffer[packetSize];
-            packetSensor->CopyData(buffer, packetSize);
-            messageData* data = (messageData*)malloc(sizeof(messageData));
-            data->source = buffer[0];
-            data->dest = buffer[1];
-            data->command = buffer[2];
-            data->payload = buffer[3];
-            
-            uint8_t* msg = (uint8_t*)malloc(sizeof(messageData));
-
-            switch (data->command)
-            {
-            case 0: // Verificar estado dos sensores
-            if(shelf4.size() > 0){ // Verifica se a fila não está vazia
-                    sensor_state_vector[3] = shelf4.front(); // Lê do vetor do log das leituras do sensor da prateleira 4 o próximo valor e atualiza a tabela de sensores.
-                    shelf4.pop(); // elimina o valor da fila.
-                    msg[0] = 4; // A nova mensagem tem como fonte o sensor da prateleira 4
-                    msg[1] = 10;  // Identificador do servidor
-                    msg[2] = data->command;  // codigo de mensagem de verificação de estado da prateleira
-                    msg[3] = sensor_state_vector[3];  // Payload assume o valor da leitura do sensor
-                    packetSensor = Create<Packet>(msg, sizeof(messageData)); // cria pacote com mensagem a ser repassada
-                    sensorSocket[1]->SendTo(packetSensor, 0, InetSocketAddress(intermediateInterfaces.GetAddress(1), port)); // repassa a mensagem para o nó intermediário entre servidor e sensores
-
-                } else { // caso esteja vazia, avisa que não há mais leituras do sensor
-                    NS_LOG_INFO("Log esvaziado. Não Há mais leituras do sensor da prateleira 4.");
-                }
-                
-                break;
-            case 1: // Esvaziar prateleria
-            if(shelf4.size() > 0){ // Verifica se a fila não está vazia
-                    sensor_state_vector[3] = false; //Esvazia a prateleira.
-                    msg[0] = 4; // A nova mensagem tem como fonte o sensor da prateleira 4
-                    msg[1] = 10;  // Identificador do servidor
-                    msg[2] = data->command;  // codigo de mensagem de verificação de estado da prateleira
-                    msg[3] = false;  // Payload assume o valor 0, indicando que a prateleira foi esvaziada
-                    packetSensor = Create<Packet>(msg, sizeof(messageData)); // cria pacote com mensagem a ser repassada
-                    sensorSocket[1]->SendTo(packetSensor, 0, InetSocketAddress(intermediateInterfaces.GetAddress(1), port)); // repassa a mensagem para o nó intermediário entre servidor e sensores
-
-                } else { // caso esteja vazia, avisa que não há mais leituras do sensor
-                    NS_LOG_INFO("Log esvaziado. Não Há mais leituras do sensor da prateleira 4.");
-                }
-
-                break;
-            case 2: // Preencher prateleira
-            if(shelf4.size() > 0){// Verifica se a fila não está vazia
-                    sensor_state_vector[3] = true; //Preenche a prateleira.
-                    msg[0] = 4; // A nova mensagem tem como fonte o sensor da prateleira 4
-                    msg[1] = 10;  // Identificador do servidor
-                    msg[2] = data->command;  // codigo de mensagem de verificação de estado da prateleira
-                    msg[3] = true;  // Payload assume o valor 0, indicando que a prateleira foi preenchida
-                    packetSensor = Create<Packet>(msg, sizeof(messageData)); // cria pacote com mensagem a ser repassada
-                    sensorSocket[1]->SendTo(packetSensor, 0, InetSocketAddress(intermediateInterfaces.GetAddress(1), port)); // repassa a mensagem para o nó intermediário entre servidor e sensores
-                }
-                break;
-            default: // Inconsistência na mensagem(Não deve entrar aqui)
-                NS_LOG_INFO("O sensor não consegue processar o comando enviado.");
-                break;
+        generator->SetAttribute("Arrival", EnumValue(load == "poisson" ? GatewayLoadGenerator::POISSON :
+                                                     load == "onoff" ? GatewayLoadGenerator::ON_OFF : GatewayLoadGenerator::TRACE));
+        generator->SetAttribute("Rate", DoubleValue(loadRate));
+        generator->SetAttribute("OnTime", TimeValue(Seconds(loadOnTime)));
+        generator->SetAttribute("OffTime", TimeValue(Seconds(loadOffTime)));
+        generator->SetAttribute("Shelves", UintegerValue(nShelves));
+        generator->SetAttribute("FillRatio", DoubleValue(fillRatio));
+        generator->SetAttribute("ZipfExponent", DoubleValue(zipfExponent));
+        gatewayApp = generator;
+    }
+    gatewayApp->SetAttribute("Port", UintegerValue(port));
+    gatewayApp->SetAttribute("RelayAddress", Ipv4AddressValue(intermediateInterfaces.GetAddress(0)));
+    gatewayApp->SetAttribute("Window", UintegerValue(gatewayWindow));
+    gatewayApp->SetAttribute("Interval", TimeValue(Seconds(gatewayPeriod)));
+    gatewayApp->SetAttribute("MaxCommands", UintegerValue(load == "instance" ? gatewayEvents : 0)); // a carga em malha aberta vai até o fim da simulação
+    gatewayApp->SetAttribute("CommandTimeout", TimeValue(Seconds(gatewayTimeout)));
+    gatewayApp->SetAttribute("Reliable", BooleanValue(reliable));
+    gatewayApp->SetEventLog(&eventLog);
+    gatewayApp->SetMetrics(nodeMetrics);
+    gatewayApp->SetLatencyCollector(&latency);
+    gatewayNode.Get(0)->AddApplication(gatewayApp);
+    gatewayApp->SetStartTime(Seconds(gatewayStart));
+    gatewayApp->SetStopTime(Seconds(stopTime));
+
+    Config::Connect("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/State/State", MakeCallback(&phyStateTrace));
+    if(topology == "aisles"){
+        for(uint32_t aisle = 0; aisle < aisleTopology.GetAisleCount(); aisle++){
+            const NetDeviceContainer& cell = aisleTopology.GetCellDevices(aisle);
+            for(uint32_t i = 0; i < cell.GetN(); i++){
+                DynamicCast<WifiNetDevice>(cell.Get(i))->GetPhy()->GetState()->TraceConnectWithoutContext("State",
+                    MakeBoundCallback(&channelStateTrace, aisleTopology.GetChannelNumber(aisle)));
             }
-
-            std::cout << "Recebido pacote de " << senderAddress << ", tamanho: " << packetSize << " bytes" << std::endl;
-            std::cout << "src: " << data->source << ", dest: " << data->dest << ", command: " << data->command << ", payload" << data->payload << std::endl;
         }
-    });
-    sensorSocket[3]->SetRecvPktInfo(true); // Enable receiving sender address information
-
-    sensorSocket[4]->SetRecvCallback([&](Ptr<Socket>socket){
-        ns3::Ptr<ns3::Packet> packetSensor;
-        ns3::Address from;
-        std::cout << "Here" << std::endl;
-        while ((packetSensor = socket->RecvFrom(from)))
-        {
-            uint32_t packetSize = packetSensor->GetSize();
-            ns3::Ipv4Address senderAddress = ns3::InetSocketAddress::ConvertFrom(from).GetIpv4();
-
-            // Lógica para processar o pacote recebido
-            // ...
-            uint8_t buffer[packetSize];
-            packetSensor->CopyData(buffer, packetSize);
-            messageData* data = (messageData*)malloc(sizeof(messageData));
-            data->source = buffer[0];
-            data->dest = buffer[1];
-            data->command = buffer[2];
-            data->payload = buffer[3];
-            
-            uint8_t* msg = (uint8_t*)malloc(sizeof(messageData));
-
-            switch (data->command)
-            {
-            case 0: // Verificar estado dos sensores
-            if(shelf5.size() > 0){ // Verifica se a fila não está vazia
-                    sensor_state_vector[4] = shelf5.front(); // Lê do vetor do log das leituras do sensor da prateleira 5 o próximo valor e atualiza a tabela de sensores.
-                    shelf5.pop(); // elimina o valor da fila.
-                    msg[0] = 5; // A nova mensagem tem como fonte o sensor da prateleira 5
-                    msg[1] = 10;  // Identificador do servidor
-                    msg[2] = data->command;  // codigo de mensagem de verificação de estado da prateleira
-                    msg[3] = sensor_state_vector[4];  // Payload assume o valor da leitura do sensor
-                    packetSensor = Create<Packet>(msg, sizeof(messageData)); // cria pacote com mensagem a ser repassada
-                    sensorSocket[1]->SendTo(packetSensor, 0, InetSocketAddress(intermediateInterfaces.GetAddress(1), port)); // repassa a mensagem para o nó intermediário entre servidor e sensores
-
-                } else { // caso esteja vazia, avisa que não há mais leituras do sensor
-                    NS_LOG_INFO("Log esvaziado. Não Há mais leituras do sensor da prateleira 5.");
-                }
-                
-                break;
-            case 1: // Esvaziar prateleria
-            if(shelf5.size() > 0){ // Verifica se a fila não está vazia
-                    sensor_state_vector[4] = false; //Esvazia a prateleira.
-                    msg[0] = 5; // A nova mensagem tem como fonte o sensor da prateleira 5
-                    msg[1] = 10;  // Identificador do servidor
-                    msg[2] = data->command;  // codigo de mensagem de verificação de estado da prateleira
-                    msg[3] = false;  // Payload assume o valor 0, indicando que a prateleira foi esvaziada
-                    packetSensor = Create<Packet>(msg, sizeof(messageData)); // cria pacote com mensagem a ser repassada
-                    sensorSocket[1]->SendTo(packetSensor, 0, InetSocketAddress(intermediateInterfaces.GetAddress(1), port)); // repassa a mensagem para o nó intermediário entre servidor e sensores
+    }
 
-                } else { // caso esteja vazia, avisa que não há mais leituras do sensor
-                    NS_LOG_INFO("Log esvaziado. Não Há mais leituras do sensor da prateleira 5.");
-                }
+    // Depois do início da última aplicação, a codificação não deveria alocar mais nada
+    Simulator::Schedule(Seconds(gatewayStart) + NanoSeconds(1), &snapshotCodecAllocations);
 
-                break;
-            case 2: // Preencher prateleira
-            if(shelf5.size() > 0){// Verifica se a fila não está vazia
-                    sensor_state_vector[4] = true; //Preenche a prateleira.
-                    msg[0] = 5; // A nova mensagem tem como fonte o sensor da prateleira 5
-                    msg[1] = 10;  // Identificador do servidor
-                    msg[2] = data->command;  // codigo de mensagem de verificação de estado da prateleira
-                    msg[3] = true;  // Payload assume o valor 0, indicando que a prateleira foi preenchida
-                    packetSensor = Create<Packet>(msg, sizeof(messageData)); // cria pacote com mensagem a ser repassada
-                    sensorSocket[1]->SendTo(packetSensor, 0, InetSocketAddress(intermediateInterfaces.GetAddress(1), port)); // repassa a mensagem para o nó intermediário entre servidor e sensores
-                }
-                break;
-            default: // Inconsistência na mensagem(Não deve entrar aqui)
-                NS_LOG_INFO("O sensor não consegue processar o comando enviado.");
-                break;
-            }
+    Simulator::Stop(Seconds(stopTime));
+    auto runStart = std::chrono::steady_clock::now();
+    ns3::Simulator::Run();
+    auto runEnd = std::chrono::steady_clock::now();
+    double runMs = std::chrono::duration<double, std::milli>(runEnd - runStart).count();
+    uint64_t nEvents = Simulator::GetEventCount();
+    double eventsPerSecond = runMs > 0 ? nEvents / (runMs / 1000.0) : 0;
+    std::cout << "Eventos simulados: " << nEvents << " em " << runMs << " ms (" << eventsPerSecond << " eventos/s)" << std::endl;
+    const PropagationCacheStats& propagationStats = MobilityPairCache::GetStats();
+    if(propagationCache){
+        std::cout << "Cache de propagação: " << propagationStats.hits << " consultas atendidas, " << propagationStats.misses
+                  << " cálculos, " << propagationStats.invalidations << " invalidações por movimento" << std::endl;
+    }
 
-            std::cout << "Recebido pacote de " << senderAddress << ", tamanho: " << packetSize << " bytes" << std::endl;
-            std::cout << "src: " << data->source << ", dest: " << data->dest << ", command: " << data->command << ", payload" << data->payload << std::endl;
+    const WireStats& stats = FrameWriter::GetStats();
+    std::cout << "Datagramas enviados: " << stats.datagrams << ", registros: " << stats.records << ", bytes de payload: " << stats.payloadBytes << std::endl;
+    const CodecAllocationStats& codecStats = GetCodecAllocationStats();
+    uint64_t steadyAllocations = codecStats.allocations - codec_allocations_started;
+    std::cout << "Alocações da codificação: " << codecStats.allocations << " (" << codecStats.bytes << " bytes), "
+              << steadyAllocations << " depois do início de todas as aplicações" << std::endl;
+    std::cout << "Bytes no ar (quadros): " << GetAirBytes(stats) << ", bytes no ar (formato antigo de 4 bytes): " << GetLegacyAirBytes(stats) << std::endl;
+    uint32_t sensorMemory = DynamicCast<ShelfSensorApplication>(sensorApps.Get(0))->GetMemoryUsage();
+    std::cout << "Memória por aplicação de sensor: " << sensorMemory << " bytes, do intermediário dos sensores: " << sensorRelay->GetMemoryUsage() << " bytes" << std::endl;
+
+    // Consistência final entre a tabela do servidor e o estado real das prateleiras
+    ShelfStateTable sensorStates(nShelves);
+    for(uint32_t i = 0; i < nShelves; i++){
+        sensorStates.Set(i, DynamicCast<ShelfSensorApplication>(sensorApps.Get(i))->GetState());
+    }
+    ShelfStateTable serverStates(nShelves); // tabelas dos servidores reunidas
+    uint32_t serverTableMemory = 0;
+    for(Ptr<WarehouseServerApplication> serverApp : serverApps){
+        const ShelfStateTable& shard = serverApp->GetStateTable();
+        for(uint32_t i = 0; i < serverApp->GetShelfCount(); i++){
+            serverStates.Set(serverApp->GetFirstShelf() - 1 + i, shard.Get(i));
         }
-    });
-    sensorSocket[4]->SetRecvPktInfo(true); // Enable receiving sender address information
-
-    sensorSocket[4]->SetRecvCallback([&](Ptr<Socket>socket){
-        ns3::Ptr<ns3::Packet> packetSensor;
-        ns3::Address from;
-        std::cout << "Here" << std::endl;
-        while ((packetSensor = socket->RecvFrom(from)))
-        {
-            uint32_t packetSize = packetSensor->GetSize();
-            ns3::Ipv4Address senderAddress = ns3::InetSocketAddress::ConvertFrom(from).GetIpv4();
-
-            // Lógica para processar o pacote recebido
-            // ...
-            uint8_t buffer[packetSize];
-            packetSensor->CopyData(buffer, packetSize);
-            messageData* data = (messageData*)malloc(sizeof(messageData));
-            data->source = buffer[0];
-            data->dest = buffer[1];
-            data->command = buffer[2];
-            data->payload = buffer[3];
-            
-            uint8_t* msg = (uint8_t*)malloc(sizeof(messageData));
-
-            switch (data->command)
-            {
-            case 0: // Verificar estado dos sensores
-            if(shelf5.size() > 0){ // Verifica se a fila não está vazia
-                    sensor_state_vector[5] = shelf6.front(); // Lê do vetor do log das leituras do sensor da prateleira 6 o próximo valor e atualiza a tabela de sensores.
-                    shelf6.pop(); // elimina o valor da fila.
-                    msg[0] = 5; // A nova mensagem tem como fonte o sensor da prateleira 6
-                    msg[1] = 10;  // Identificador do servidor
-                    msg[2] = data->command;  // codigo de mensagem de verificação de estado da prateleira
-                    msg[3] = sensor_state_vector[5];  // Payload assume o valor da leitura do sensor
-                    packetSensor = Create<Packet>(msg, sizeof(messageData)); // cria pacote com mensagem a ser repassada
-                    sensorSocket[1]->SendTo(packetSensor, 0, InetSocketAddress(intermediateInterfaces.GetAddress(1), port)); // repassa a mensagem para o nó intermediário entre servidor e sensores
-
-                } else { // caso esteja vazia, avisa que não há mais leituras do sensor
-                    NS_LOG_INFO("Log esvaziado. Não Há mais leituras do sensor da prateleira 6.");
-                }
-                
-                break;
-            case 1: // Esvaziar prateleria
-            if(shelf6.size() > 0){ // Verifica se a fila não está vazia
-                    sensor_state_vector[5] = false; //Esvazia a prateleira.
-                    msg[0] = 6; // A nova mensagem tem como fonte o sensor da prateleira 6
-                    msg[1] = 10;  // Identificador do servidor
-                    msg[2] = data->command;  // codigo de mensagem de verificação de estado da prateleira
-                    msg[3] = false;  // Payload assume o valor 0, indicando que a prateleira foi esvaziada
-                    packetSensor = Create<Packet>(msg, sizeof(messageData)); // cria pacote com mensagem a ser repassada
-                    sensorSocket[1]->SendTo(packetSensor, 0, InetSocketAddress(intermediateInterfaces.GetAddress(1), port)); // repassa a mensagem para o nó intermediário entre servidor e sensores
-
-                } else { // caso esteja vazia, avisa que não há mais leituras do sensor
-                    NS_LOG_INFO("Log esvaziado. Não Há mais leituras do sensor da prateleira 6.");
-                }
-
-                break;
-            case 2: // Preencher prateleira
-            if(shelf6.size() > 0){// Verifica se a fila não está vazia
-                    sensor_state_vector[5] = true; //Preenche a prateleira.
-                    msg[0] = 6; // A nova mensagem tem como fonte o sensor da prateleira 6
-                    msg[1] = 10;  // Identificador do servidor
-                    msg[2] = data->command;  // codigo de mensagem de verificação de estado da prateleira
-                    msg[3] = true;  // Payload assume o valor 0, indicando que a prateleira foi preenchida
-                    packetSensor = Create<Packet>(msg, sizeof(messageData)); // cria pacote com mensagem a ser repassada
-                    sensorSocket[1]->SendTo(packetSensor, 0, InetSocketAddress(intermediateInterfaces.GetAddress(1), port)); // repassa a mensagem para o nó intermediário entre servidor e sensores
+        serverTableMemory += shard.GetMemoryUsage();
+    }
+    std::vector<uint32_t> discrepancies;
+    uint32_t nDivergent = ShelfStateTable::Compare(serverStates, sensorStates, discrepancies);
+    std::cout << "Prateleiras cheias segundo o" << (serverShards > 1 ? "s " + std::to_string(serverShards) + " servidores" : std::string(" servidor")) << ": "
+              << serverStates.CountFull() << "/" << nShelves << ", divergentes dos sensores ao fim da simulação: " << nDivergent
+              << ", memória das tabelas: " << serverTableMemory << " bytes" << std::endl;
+    latency.Print(std::cout);
+    const SensorReportStats& reportStats = ShelfSensorApplication::GetStats();
+    std::cout << "Respostas de sensores a verificações: " << reportStats.sent << " enviadas (" << reportStats.heartbeats << " sinais de vida), "
+              << reportStats.suppressed << " omitidas por estado inalterado" << std::endl;
+    uint32_t silentSensors = 0;
+    if(deltaReporting && heartbeatPolls > 0){ // sensores que não deram sinal de vida dentro do prazo
+        Time deadline = Seconds((heartbeatPolls + 1) * pollPeriod);
+        for(Ptr<WarehouseServerApplication> serverApp : serverApps){
+            for(uint32_t i = 0; i < serverApp->GetShelfCount(); i++){
+                if(Simulator::Now() - serverApp->GetLastHeard(i) > deadline){
+                    silentSensors++;
                 }
-                break;
-            default: // Inconsistência na mensagem(Não deve entrar aqui)
-                NS_LOG_INFO("O sensor não consegue processar o comando enviado.");
-                break;
             }
-
-            std::cout << "Recebido pacote de " << senderAddress << ", tamanho: " << packetSize << " bytes" << std::endl;
-            std::cout << "src: " << data->source << ", dest: " << data->dest << ", command: " << data->command << ", payload" << data->payload << std::endl;
         }
-    });
-    sensorSocket[5]->SetRecvPktInfo(true); // Enable receiving sender address information
-
-    gatewaySocket->SetRecvCallback([&](Ptr<Socket> socket){
-        ns3::Ptr<ns3::Packet> packetGateway;
-        ns3::Address from;
-        std::cout << "Here" << std::endl;
-        while ((packetGateway = socket->RecvFrom(from)))
-        {
-            uint32_t packetSize = packetGateway->GetSize();
-            ns3::Ipv4Address senderAddress = ns3::InetSocketAddress::ConvertFrom(from).GetIpv4();
-
-            // Lógica para processar o pacote recebido
-            // ...
-            uint8_t buffer[packetSize];
-            packetGateway->CopyData(buffer, packetSize);
-            messageData* data = (messageData*)malloc(sizeof(messageData));
-            data->source = buffer[0];
-            data->dest = buffer[1];
-            data->command = buffer[2];
-            data->payload = buffer[3];
-
-            switch (data->command)
-            {
-            case 1:
-                NS_LOG_INFO("Produto dispachado com sucesso");
-                break;
-            case 2:
-                NS_LOG_INFO("Produto armazenado com sucesso");
-                break;
-            case 5:
-                if(data->payload == 5)
-                    NS_LOG_INFO("Inconsistência de valores, alertando central");
-                else if(data->payload == 4)
-                    NS_LOG_INFO("Tentativa de armazenar produto em prateleira ocupada");
-                else if(data->payload == 3)
-                    NS_LOG_INFO("Tentativa de retirar produto de prateleira vazia");
-
-            default:
-                break;
+        std::cout << "Sensores sem sinal de vida nas últimas " << heartbeatPolls + 1 << " verificações: " << silentSensors << std::endl;
+    }
+    // Rodadas de verificação somadas dos servidores: cada servidor conta as rodadas das suas prateleiras
+    std::vector<double> verify_completion;
+    uint32_t verify_rounds = 0;
+    uint32_t verify_missing = 0;
+    for(Ptr<WarehouseServerApplication> serverApp : serverApps){
+        verify_completion.insert(verify_completion.end(), serverApp->GetVerifyCompletion().begin(), serverApp->GetVerifyCompletion().end());
+        verify_rounds += serverApp->GetVerifyRounds();
+        verify_missing += serverApp->GetVerifyMissing();
+    }
+    double verifyCompletion = 0;
+    for(double completion : verify_completion){
+        verifyCompletion += completion;
+    }
+    verifyCompletion = verify_completion.empty() ? 0 : verifyCompletion / verify_completion.size();
+    const ArqStats& arqStats = ArqEndpoint::GetStats();
+    double goodput = arqStats.deliveredBytes * 8 / stopTime / 1000.0;
+    const GatewayClientStats& gatewayStats = GatewayClientApplication::GetStats();
+    double completionRate = gatewayStats.issued == 0 ? 0 : (double) gatewayStats.completed / gatewayStats.issued;
+    Time commandSpan = gatewayStats.lastCompletion - gatewayStats.firstIssue;
+    double offeredLoad = stopTime > gatewayStart ? gatewayStats.issued / (stopTime - gatewayStart) : 0;
+    double commandThroughput = commandSpan.IsStrictlyPositive() ? gatewayStats.completed / commandSpan.GetSeconds() : 0;
+    std::cout << "Entrega " << (reliable ? "confiável" : "sem confirmação") << " com taxa de erro " << errorRate << ": " << arqStats.reliableFrames << " quadros confiáveis, "
+              << arqStats.retransmissions << " reenvios, " << arqStats.acksSent << " confirmações, " << arqStats.duplicates << " repetidos descartados, "
+              << arqStats.failed << " abandonados; goodput " << goodput << " kbit/s" << std::endl;
+    std::cout << "Comandos do gateway concluídos: " << gatewayStats.completed << "/" << gatewayStats.issued << " (" << completionRate * 100 << "%), "
+              << gatewayStats.timedOut << " sem resposta no prazo (" << gatewayStats.late << " respondidos depois), vazão "
+              << commandThroughput << " comandos/s";
+    if(load != "instance"){
+        std::cout << " para uma carga oferecida (" << load << ") de " << offeredLoad << " comandos/s" << std::endl;
+    }else{
+        std::cout << (gatewayWindow > 0 ? " com janela " + std::to_string(gatewayWindow) : std::string(" em ritmo fixo")) << std::endl;
+    }
+    const ServerBatchStats& batchStats = WarehouseServerApplication::GetStats();
+    std::cout << "Comandos aceitos pelo servidor: " << batchStats.commands << ", enviados em " << batchStats.batches << " lotes ("
+              << batchStats.batchedCommands << " junto com outros comandos), " << batchStats.coalesced << " anulados por comandos opostos" << std::endl;
+    // Com deltaReporting os sensores inalterados não respondem, então uma rodada nunca recebe todas as respostas
+    std::cout << "Verificação (" << verifyMode << "): ";
+    if(deltaReporting){
+        std::cout << verify_rounds << " rodadas, duração não medida com deltaReporting";
+    }else{
+        std::cout << verify_completion.size() << "/" << verify_rounds << " rodadas completas, duração média " << verifyCompletion << " ms";
+    }
+    std::cout << ", respostas ausentes nos relatórios agregados: " << verify_missing << ", tempo total de transmissão dos rádios: " << airtime.GetSeconds() * 1000.0 << " ms" << std::endl;
+    // Ocupação de cada canal: tempo em que ao menos um rádio das células do canal transmitia, sobre a duração da simulação
+    double maxChannelUtilization = 0;
+    if(topology == "aisles"){
+        std::map<uint8_t, std::vector<uint32_t>> channelCells;
+        for(uint32_t aisle = 0; aisle < aisleTopology.GetAisleCount(); aisle++){
+            channelCells[aisleTopology.GetChannelNumber(aisle)].push_back(aisle);
+        }
+        std::cout << "Canais: " << channelCells.size() << " para " << aisleTopology.GetAisleCount() << " células" << std::endl;
+        for(const auto& entry : channelCells){
+            double utilization = channel_busy[entry.first].busy.GetSeconds() / stopTime;
+            maxChannelUtilization = std::max(maxChannelUtilization, utilization);
+            std::cout << "  canal " << (uint32_t)entry.first << ": ocupação " << utilization * 100.0 << "% ("
+                      << channel_busy[entry.first].busy.GetSeconds() * 1000.0 << " ms), corredores";
+            for(uint32_t aisle : entry.second){
+                std::cout << " " << aisle;
             }
-
-            std::cout << "Recebido pacote de " << senderAddress << ", tamanho: " << packetSize << " bytes" << std::endl;
-            std::cout << "src: " << data->source << ", dest: " << data->dest << ", command: " << data->command << ", payload" << data->payload << std::endl;
+            std::cout << std::endl;
         }
-    });
-    for(uint8_t i = 0; i < 10; i++){
-        Simulator::Schedule(Seconds(i + 0.5), &gatewayEvent, gatewaySocket, intermediateInterfaces.GetAddress(0));
-        Simulator::Schedule(Seconds(i + 1.0), &verify, serverSocket, intermediateInterfaces.GetAddress(1));
+    }
+    eventLog.Close();
+    if(eventLog.IsEnabled(EVENT_LOG_PACKETS)){
+        std::cout << "Eventos registrados: " << eventLog.GetLogged() << " em " << eventLogPath << std::endl;
     }
 
-    Simulator::Stop(Seconds(11.0));
-    ns3::Simulator::Run();
-    ns3::Simulator::Destroy();
+    if(!summaryPath.empty()){ // uma linha de cabeçalho e uma de valores, agregadas por sweep.sh
+        std::ofstream summary(summaryPath);
+        if(!summary){
+            std::cout << "Erro ao gravar o resumo em " << summaryPath << std::endl;
+            ns3::Simulator::Destroy();
+            return 1;
+        }
+        summary << "shelves,datagrams,records,payload_bytes,air_bytes,legacy_air_bytes,codec_allocations,codec_steady_allocations,"
+                << "sensor_memory,divergent_shelves,setup_ms,run_ms,events,dispatch_p50_ms,dispatch_p95_ms,dispatch_p99_ms,"
+                << "verify_rounds,verify_complete,verify_completion_ms,verify_missing,airtime_ms,"
+                << "reports_sent,reports_suppressed,heartbeats,silent_sensors,"
+                << "reliable_frames,retransmissions,acks,duplicates,arq_failed,goodput_kbps,commands_sent,commands_completed,completion_rate,"
+                << "commands_timed_out,command_throughput,offered_load,server_shards,server_commands,batches,batched_commands,coalesced_commands,aisles,channels,max_channel_utilization,"
+                << "events_per_s,propagation_cache,propagation_cache_hits,propagation_cache_misses" << std::endl;
+        summary << nShelves << "," << stats.datagrams << "," << stats.records << "," << stats.payloadBytes << ","
+                << GetAirBytes(stats) << "," << GetLegacyAirBytes(stats) << "," << codecStats.allocations << "," << steadyAllocations << ","
+                << sensorMemory << "," << nDivergent << "," << std::chrono::duration<double, std::milli>(setupEnd - setupStart).count() << ","
+                << runMs << "," << nEvents << "," << latency.GetPercentile(COMMAND_EMPTY, 50) << ","
+                << latency.GetPercentile(COMMAND_EMPTY, 95) << "," << latency.GetPercentile(COMMAND_EMPTY, 99) << ","
+                << verify_rounds << "," << (deltaReporting ? "" : std::to_string(verify_completion.size())) << ","
+                << (deltaReporting ? "" : std::to_string(verifyCompletion)) << "," << verify_missing << "," << airtime.GetSeconds() * 1000.0 << ","
+                << reportStats.sent << "," << reportStats.suppressed << "," << reportStats.heartbeats << "," << silentSensors << ","
+                << arqStats.reliableFrames << "," << arqStats.retransmissions << "," << arqStats.acksSent << "," << arqStats.duplicates << ","
+                << arqStats.failed << "," << goodput << "," << gatewayStats.issued << "," << gatewayStats.completed << "," << completionRate << ","
+                << gatewayStats.timedOut << "," << commandThroughput << "," << offeredLoad << "," << serverShards << "," << batchStats.commands << ","
+                << batchStats.batches << "," << batchStats.batchedCommands << "," << batchStats.coalesced << "," << nAisles << ","
+                << (topology == "aisles" ? aisleTopology.GetChannelCount() : 1) << "," << maxChannelUtilization << ","
+                << eventsPerSecond << "," << propagationCache << "," << propagationStats.hits << "," << propagationStats.misses << std::endl;
+    }
+    ns3::Simulator::Destroy(); // grava as métricas
+    if(nodeMetrics){
+        std::cout << "Métricas por nó gravadas em " << metricsPath << std::endl;
+    }
 
     return 0;
 }
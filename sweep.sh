@@ -0,0 +1,108 @@
+# Parameter sweep over the warehouse scenario, running independent simulations on all local cores.
+# Like run.sh, it needs NS3_DIR exported to the ns-3.38 directory in your machine.
+#
+# Usage: ./sweep.sh [-j jobs] [-r runs] [-o output_dir] name=v1,v2,... [name=v1,v2,...]
+#   name   any option of src/main.cc (sensors, pollPeriod, dataMode, ...)
+#   -j     simultaneous simulations (default: number of cores)
+#   -r     RNG runs per parameter combination, passed as --RngRun=1..runs (default: 1)
+#   -o     output directory (default: sweep_results)
+#
+# Example: ./sweep.sh -r 5 sensors=2,4,6 pollPeriod=0.5,1.0 dataMode=VhtMcs0,VhtMcs9
+#
+# Each simulation writes <output_dir>/runs/<id>.csv, where <id> is built from its parameters, and its
+# output to <id>.log. Simulations whose .csv already exists are skipped, so an interrupted sweep is
+# resumed by running the same command again. At the end all runs are gathered in <output_dir>/results.csv.
+
+JOBS=$(nproc)
+RUNS=1
+OUT=sweep_results
+
+while getopts "j:r:o:" opt; do
+    case $opt in
+        j) JOBS=$OPTARG ;;
+        r) RUNS=$OPTARG ;;
+        o) OUT=$OPTARG ;;
+        *) exit 1 ;;
+    esac
+done
+shift $((OPTIND - 1))
+
+if [ -z "${NS3_DIR}" ]; then
+    echo "NS3_DIR is not set"
+    exit 1
+fi
+OUT=$(realpath -m "$OUT")
+mkdir -p "$OUT/runs"
+
+# 1. Copying the src folder to the NS3 directory and building once, so the simulations only run
+cp -r src/ ${NS3_DIR}/scratch
+(cd ${NS3_DIR} && ./ns3 build scratch/src/main) || exit 1
+
+# 2. Cartesian product of the parameter lists, one line of "name=value" options per combination
+COMBOS=("")
+NAMES=()
+for spec in "$@"; do
+    name=${spec%%=*}
+    NAMES+=("$name")
+    IFS=',' read -ra values <<< "${spec#*=}"
+    NEXT=()
+    for combo in "${COMBOS[@]}"; do
+        for value in "${values[@]}"; do
+            NEXT+=("$combo $name=$value")
+        done
+    done
+    COMBOS=("${NEXT[@]}")
+done
+
+JOBLIST="$OUT/jobs.txt"
+: > "$JOBLIST"
+for combo in "${COMBOS[@]}"; do
+    for run in $(seq 1 "$RUNS"); do
+        echo "$combo RngRun=$run" | sed 's/^ //' >> "$JOBLIST"
+    done
+done
+echo "$(wc -l < "$JOBLIST") simulations, $(ls "$OUT/runs" | grep -c '\.csv$') already done, $JOBS at a time"
+
+# 3. Running the simulations. The summary is written to a temporary file and renamed only when the
+# simulation succeeds, so a killed simulation is not mistaken for a finished one.
+run_one() {
+    id=$(echo "$1" | tr ' =/' '_+-')
+    [ -f "$OUT/runs/$id.csv" ] && return 0
+    args=""
+    for option in $1; do
+        args="$args --$option"
+    done
+    cd ${NS3_DIR}
+    if ./ns3 run --no-build "scratch/src/main.cc $args --summary=$OUT/runs/$id.csv.tmp" > "$OUT/runs/$id.log" 2>&1 \
+        && [ -f "$OUT/runs/$id.csv.tmp" ]; then
+        mv "$OUT/runs/$id.csv.tmp" "$OUT/runs/$id.csv"
+        echo "done   $1"
+    else
+        rm -f "$OUT/runs/$id.csv.tmp"
+        echo "FAILED $1 (see $OUT/runs/$id.log)"
+    fi
+}
+export -f run_one
+export OUT NS3_DIR
+
+tr '\n' '\0' < "$JOBLIST" | xargs -0 -P "$JOBS" -I{} bash -c 'run_one "$1"' _ {}
+
+# 4. Gathering the per-run summaries: the parameters of each run followed by its metrics
+RESULTS="$OUT/results.csv"
+HEADER=""
+: > "$RESULTS"
+while read -r line; do
+    id=$(echo "$line" | tr ' =/' '_+-')
+    summary="$OUT/runs/$id.csv"
+    [ -f "$summary" ] || continue
+    if [ -z "$HEADER" ]; then
+        HEADER="$(echo "${NAMES[@]} RngRun" | sed 's/^ //' | tr ' ' ','),$(head -n 1 "$summary")"
+        echo "$HEADER" >> "$RESULTS"
+    fi
+    values=""
+    for option in $line; do
+        values="$values,${option#*=}"
+    done
+    echo "${values#,},$(sed -n 2p "$summary")" >> "$RESULTS"
+done < "$JOBLIST"
+echo "$(grep -c . "$RESULTS" | awk '{print ($1 > 0 ? $1 - 1 : 0)}') results in $RESULTS"